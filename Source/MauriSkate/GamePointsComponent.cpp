@@ -2,6 +2,14 @@
 
 
 #include "GamePointsComponent.h"
+#include "SkateLeaderboardSubsystem.h"
+#include "SkateTelemetry.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PawnMovementComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
 
 // Sets default values for this component's properties
 UGamePointsComponent::UGamePointsComponent()
@@ -19,8 +27,22 @@ void UGamePointsComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// ...
-	
+	RunStartTime = GetWorld()->GetTimeSeconds();
+
+	if (USkateResetSubsystem* Reset = GetWorld()->GetSubsystem<USkateResetSubsystem>())
+	{
+		Reset->RegisterResettable(this);
+	}
+}
+
+void UGamePointsComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USkateResetSubsystem* Reset = GetWorld()->GetSubsystem<USkateResetSubsystem>())
+	{
+		Reset->UnregisterResettable(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 
@@ -29,13 +51,139 @@ void UGamePointsComponent::TickComponent(float DeltaTime, ELevelTick TickType, F
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	// ...
+	// Airtime bonus needs to know how long we've been off the ground
+	const APawn* Pawn = GetScoringPawn();
+	const UPawnMovementComponent* Movement = Pawn ? Pawn->GetMovementComponent() : nullptr;
+	CurrentAirtime = (Movement && Movement->IsFalling()) ? CurrentAirtime + DeltaTime : 0.0f;
+
+	FlushAwards();
 }
 
 void UGamePointsComponent::AwardPoints(int NewPoints)
 {
-	PointsAccumulated += NewPoints;
-	GEngine->AddOnScreenDebugMessage(-1, 10.0f, FColor::Yellow, FString::Printf(TEXT("Just Awarded %i points. Total %i"), NewPoints, PointsAccumulated));
+	QueuedAwards.Add({ NewPoints, CurrentAirtime });
+}
+
+void UGamePointsComponent::FlushAwards()
+{
+	if (QueuedAwards.IsEmpty())
+	{
+		return;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	FPointsAwardBreakdown Breakdown;
+	Breakdown.NumAwards = QueuedAwards.Num();
+
+	for (const FQueuedAward& Award : QueuedAwards)
+	{
+		// Awards on the same frame always chain
+		ComboCount = (Now - LastAwardTime <= ComboWindow) ? ComboCount + 1 : 1;
+		LastAwardTime = Now;
+
+		const float Multiplier = FMath::Min(1.0f + ComboMultiplierStep * (ComboCount - 1), MaxComboMultiplier);
+		const int32 AirtimeBonus = FMath::RoundToInt32(Award.Airtime * AirtimeBonusPerSecond);
+		const int32 Points = FMath::RoundToInt32((Award.Points + AirtimeBonus) * Multiplier);
+
+		Breakdown.BasePoints += Award.Points;
+		Breakdown.AirtimeBonus += AirtimeBonus;
+		Breakdown.ComboBonus += Points - (Award.Points + AirtimeBonus);
+		Breakdown.AwardedPoints += Points;
+		Breakdown.Multiplier = Multiplier;
+	}
+
+	QueuedAwards.Reset();
+
+	ObstaclesCleared += Breakdown.NumAwards;
+	PointsAccumulated += Breakdown.AwardedPoints;
+	Breakdown.ComboCount = ComboCount;
+	Breakdown.TotalPoints = PointsAccumulated;
+
+	SKATE_TRACE_AWARD(GetOwner(), Breakdown.AwardedPoints, PointsAccumulated);
+
+	// One broadcast per frame however many awards landed
+	OnPointsAwarded.Broadcast(PointsAccumulated);
+	OnPointsFlushed.Broadcast(Breakdown);
+}
+
+int32 UGamePointsComponent::FinishRun(const FString& GhostRunName)
+{
+	if (bRunFinished)
+	{
+		return INDEX_NONE;
+	}
+
+	// Awards still queued this frame belong to the run
+	FlushAwards();
+	bRunFinished = true;
+
+	USkateLeaderboardSubsystem* Leaderboard = GetWorld()->GetGameInstance() ? GetWorld()->GetGameInstance()->GetSubsystem<USkateLeaderboardSubsystem>() : nullptr;
+	if (!Leaderboard)
+	{
+		return INDEX_NONE;
+	}
+
+	FSkateRunRecord Run;
+	Run.Level = UGameplayStatics::GetCurrentLevelName(this);
+	Run.Score = PointsAccumulated;
+	Run.Time = GetWorld()->GetTimeSeconds() - RunStartTime;
+	Run.ObstaclesCleared = ObstaclesCleared;
+	Run.FinishedAt = FDateTime::UtcNow();
+	Run.GhostRunName = GhostRunName;
+
+	return Leaderboard->SubmitRun(Run);
+}
+
+void UGamePointsComponent::CaptureResetState()
+{
+	ResetPoints = PointsAccumulated;
+}
+
+void UGamePointsComponent::RestoreResetState()
+{
+	StartRun();
+}
+
+void UGamePointsComponent::StartRun()
+{
+	// A fresh run, awards from the old one are dropped
+	QueuedAwards.Reset();
+	PointsAccumulated = ResetPoints;
+	CurrentAirtime = 0.0f;
+	ComboCount = 0;
+	LastAwardTime = -UE_BIG_NUMBER;
+	ObstaclesCleared = 0;
+	RunStartTime = GetWorld()->GetTimeSeconds();
+	bRunFinished = false;
+
 	OnPointsAwarded.Broadcast(PointsAccumulated);
 }
 
+APawn* UGamePointsComponent::GetScoringPawn() const
+{
+	if (const AController* Controller = Cast<AController>(GetOwner()))
+	{
+		return Controller->GetPawn();
+	}
+
+	return Cast<APawn>(GetOwner());
+}
+
+UGamePointsComponent* UGamePointsComponent::FindForPawn(const APawn* Pawn)
+{
+	if (!Pawn)
+	{
+		return nullptr;
+	}
+
+	if (const AController* Controller = Pawn->GetController())
+	{
+		if (UGamePointsComponent* Points = Controller->FindComponentByClass<UGamePointsComponent>())
+		{
+			return Points;
+		}
+	}
+
+	return Pawn->FindComponentByClass<UGamePointsComponent>();
+}
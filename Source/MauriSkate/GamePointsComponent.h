@@ -4,30 +4,154 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "SkateResetSubsystem.h"
 #include "GamePointsComponent.generated.h"
 
+// How the points flushed on a frame were put together
+USTRUCT(BlueprintType)
+struct FPointsAwardBreakdown
+{
+	GENERATED_BODY()
+
+	// Points of every award on the frame, before any rule
+	UPROPERTY(BlueprintReadOnly, Category="Points")
+	int32 BasePoints = 0;
+
+	// Extra points for being in the air when scoring
+	UPROPERTY(BlueprintReadOnly, Category="Points")
+	int32 AirtimeBonus = 0;
+
+	// Extra points from the combo multiplier
+	UPROPERTY(BlueprintReadOnly, Category="Points")
+	int32 ComboBonus = 0;
+
+	// Combo multiplier in use by the end of the frame
+	UPROPERTY(BlueprintReadOnly, Category="Points")
+	float Multiplier = 1.0f;
+
+	// Consecutive awards in the current combo
+	UPROPERTY(BlueprintReadOnly, Category="Points")
+	int32 ComboCount = 0;
+
+	// Number of awards that landed on the frame
+	UPROPERTY(BlueprintReadOnly, Category="Points")
+	int32 NumAwards = 0;
+
+	// Points added on the frame, all bonuses included
+	UPROPERTY(BlueprintReadOnly, Category="Points")
+	int32 AwardedPoints = 0;
+
+	// Points after the frame
+	UPROPERTY(BlueprintReadOnly, Category="Points")
+	int32 TotalPoints = 0;
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPointsAwarded, int, PointsAmount);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPointsFlushed, const FPointsAwardBreakdown&, Breakdown);
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
-class MAURISKATE_API UGamePointsComponent : public UActorComponent
+class MAURISKATE_API UGamePointsComponent : public UActorComponent, public ISkateResettable
 {
 	GENERATED_BODY()
 
 public:	
 	// Sets default values for this component's properties
 	UGamePointsComponent();
+
+	// Broadcast at most once per frame with the new total
 	UPROPERTY(BlueprintAssignable, BlueprintCallable)
 	FOnPointsAwarded OnPointsAwarded;
 
+	// Broadcast at most once per frame with how the awarded points were put together
+	UPROPERTY(BlueprintAssignable, BlueprintCallable)
+	FOnPointsFlushed OnPointsFlushed;
+
+	// Awards closer than this in time chain into a combo
+	UPROPERTY(EditAnywhere, Category="Points", meta = (ClampMin = 0, Units = "s"))
+	float ComboWindow = 2.0f;
+
+	// Multiplier added for every award in a combo after the first one
+	UPROPERTY(EditAnywhere, Category="Points", meta = (ClampMin = 0))
+	float ComboMultiplierStep = 0.5f;
+
+	// Combo multiplier cap
+	UPROPERTY(EditAnywhere, Category="Points", meta = (ClampMin = 1))
+	float MaxComboMultiplier = 4.0f;
+
+	// Bonus points per second the scoring pawn has been in the air when an award lands
+	UPROPERTY(EditAnywhere, Category="Points", meta = (ClampMin = 0))
+	float AirtimeBonusPerSecond = 2.0f;
+
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+	// Called when the game ends or the component is removed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	int PointsAccumulated = 0;
 
 public:	
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+	// Queues points. Every award on a frame is scored and broadcast together on the next tick
 	void AwardPoints(int NewPoints);
+
+	UFUNCTION(BlueprintPure, Category="Points")
+	int GetPoints() const { return PointsAccumulated; }
+
+	// Submits the run so far to the local leaderboard. Returns its rank on the level, or INDEX_NONE if it didn't make the top runs
+	// Called by the scoring skater when it crashes. A run is only submitted once, until StartRun
+	UFUNCTION(BlueprintCallable, Category="Points")
+	int32 FinishRun(const FString& GhostRunName);
+
+	// Drops the current run and starts a new one from the reset points. Called by the scoring skater once it's back on the board, and on a world reset
+	UFUNCTION(BlueprintCallable, Category="Points")
+	void StartRun();
+
+	// ~begin ISkateResettable interface
+	virtual void CaptureResetState() override;
+	virtual void RestoreResetState() override;
+	// ~end ISkateResettable interface
+
+	// Finds the points component for a pawn, on its controller first and then on the pawn itself
+	static UGamePointsComponent* FindForPawn(const APawn* Pawn);
+
+private:
+	// An award waiting for the end of the frame
+	struct FQueuedAward
+	{
+		int32 Points;
+		float Airtime;
+	};
+
+	// Applies the scoring rules to the queued awards and broadcasts the result
+	void FlushAwards();
+
+	// The pawn scoring with this component, either the controlled pawn or the owner
+	APawn* GetScoringPawn() const;
+
+	TArray<FQueuedAward, TInlineAllocator<8>> QueuedAwards;
+
+	// Time the scoring pawn has been in the air
+	float CurrentAirtime = 0.0f;
+
+	// Consecutive awards in the current combo
+	int32 ComboCount = 0;
+
+	// World time of the last award
+	double LastAwardTime = -UE_BIG_NUMBER;
+
+	// Awards scored in the current run
+	int32 ObstaclesCleared = 0;
+
+	// World time the current run started
+	double RunStartTime = 0.0;
+
+	// Set once the current run went to the leaderboard
+	bool bRunFinished = false;
+
+	// Points to start over with on a world reset
+	int32 ResetPoints = 0;
 };
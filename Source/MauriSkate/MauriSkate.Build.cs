@@ -21,7 +21,7 @@ public class MauriSkate : ModuleRules
 			"Slate"
 		});
 
-		PrivateDependencyModuleNames.AddRange(new string[] { });
+		PrivateDependencyModuleNames.AddRange(new string[] { "TraceLog" });
 
 		PublicIncludePaths.AddRange(new string[] {
 			"MauriSkate",
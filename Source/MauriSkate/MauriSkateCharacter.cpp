@@ -11,78 +11,99 @@
 #include "EnhancedInputSubsystems.h"
 #include "InputActionValue.h"
 #include "MauriSkate.h"
-#include "Chaos/Utilities.h"
-#include "Kismet/GameplayStatics.h"
+#include "MauriSkateMovementComponent.h"
+#include "SkateBoardAlignmentComponent.h"
+#include "SkateTelemetry.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "ObstacleWorldSubsystem.h"
+#include "SkateRagdollBudgetSubsystem.h"
+#include "GamePointsComponent.h"
+#include "SkateGhostRecorderComponent.h"
 
 void AMauriSkateCharacter::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
 
-	SkatePushRemainingTime = FMath::Clamp(SkatePushRemainingTime-DeltaSeconds,0.0,FLT_MAX);
+	if (bIsRagdoll)
+	{
+		UpdateRagdoll(DeltaSeconds);
+	}
 
+	// push timing runs inside the fixed rate skate simulation, we only mirror it for the animation BP
 	bIsJumping = IsJumpingNow();
 	bIsPushing = IsPushingNow();
-	
-	if (bIsPushing &&
-		!bPushingInstantReached &&
-		(SkatePushRemainingTime <= (1-SkatePushAnimationInstantNormalized)*SkatePushAnimationDuration)
-		)
+
+	// the board visuals only update on state changes
+	SetSkateBoardState(ComputeSkateBoardState());
+}
+
+void AMauriSkateCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// visuals are interpolated between skate simulation steps
+	GetSkateMovement()->AddSkatePresentationComponent(GetMesh());
+	GetSkateMovement()->AddSkatePresentationComponent(SkateMesh, true);
+
+	// a single dynamic instance drives the board state through one parameter
+	if (!SkateStateMaterialParameter.IsNone())
 	{
-		DoPush(1.0);
-		bPushingInstantReached = true;
-	} else if (bIsJumping)
+		SkateMaterialInstance = SkateMesh->CreateDynamicMaterialInstance(0, SkateReadyMaterial);
+	}
+
+	ApplySkateBoardVisuals();
+
+	// obstacles are tested against our capsule once per frame by the subsystem
+	if (UObstacleWorldSubsystem* Obstacles = GetWorld()->GetSubsystem<UObstacleWorldSubsystem>())
 	{
-		// cancels pushng if starts to be in the air
-		SkatePushRemainingTime = 0.0;
+		Obstacles->RegisterSkater(this);
 	}
 
-	if (SkatePushRemainingTime <= 0)
+	// retries put us back here instead of reloading the level
+	if (USkateResetSubsystem* Reset = GetWorld()->GetSubsystem<USkateResetSubsystem>())
 	{
-		bPushingInstantReached = false;
-		bIsPushing = false;
+		Reset->RegisterResettable(this);
 	}
+}
 
-	if (GetCharacterMovement()->IsMovingOnGround())
+void AMauriSkateCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UObstacleWorldSubsystem* Obstacles = GetWorld()->GetSubsystem<UObstacleWorldSubsystem>())
 	{
-		const FFindFloorResult Floor = GetCharacterMovement()->CurrentFloor;
-		const FVector FloorNormal = Floor.HitResult.ImpactNormal;
-		const FVector FloorPoint = Floor.HitResult.ImpactPoint;
+		Obstacles->UnregisterSkater(this);
+	}
 
-		if (FloorNormal.Dot(FVector::UpVector) < 0.98)
-		{
-			
-			const FVector Ramp = (FloorNormal * FVector(1.0,1.0,0.00)).GetSafeNormal(0.001);
-			const FVector DownsideFacing =
-				(Ramp.Dot(GetActorForwardVector()) > Ramp.Dot(GetActorForwardVector()*(-1.0))) ?
-			GetActorForwardVector() : GetActorForwardVector()*(-1.0);
-
-			const FVector Inclination = FVector::VectorPlaneProject(DownsideFacing, FloorNormal).GetSafeNormal(0.001);
-			const FVector FinalForce =
-				Inclination * (Inclination.Dot(FVector::DownVector) * GetWorld()->GetGravityZ() * -1.0 * GetCharacterMovement()->Mass * SkateGravityFactor);
-
-			GetCharacterMovement()->AddForce(FinalForce);
-
-			/*GEngine->AddOnScreenDebugMessage(-1, 0.25f, FColor::Blue,
-				FString::Printf(TEXT("Ramp:%s ; Downside:%s ; Inclination:%s ; Final:%s"),
-					*(Ramp.ToString()),
-					*(DownsideFacing.ToString()),
-					*(Inclination.ToString()),
-					*(FinalForce.ToString())
-					));*/
-		}
+	if (USkateResetSubsystem* Reset = GetWorld()->GetSubsystem<USkateResetSubsystem>())
+	{
+		Reset->UnregisterResettable(this);
 	}
 
-	if (bIsPushing || bIsJumping || bIsSlowingDown)
+	Super::EndPlay(EndPlayReason);
+}
+
+void AMauriSkateCharacter::NotifyControllerChanged()
+{
+	Super::NotifyControllerChanged();
+
+	// the first run starts once the player has control of us
+	if (!GhostRecorder->IsRecording())
 	{
-		SetSkateAlternativeMaterial(true);
-	} else
+		StartGhostRun();
+	}
+}
+
+void AMauriSkateCharacter::StartGhostRun()
+{
+	if (!IsPlayerControlled() || !IsLocallyControlled())
 	{
-		SetSkateAlternativeMaterial(false);
+		return;
 	}
-	
+
+	GhostRecorder->StartRecording(FString::Printf(TEXT("Run-%s"), *FDateTime::UtcNow().ToString(TEXT("%Y%m%d-%H%M%S-%s"))));
 }
 
-AMauriSkateCharacter::AMauriSkateCharacter()
+AMauriSkateCharacter::AMauriSkateCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UMauriSkateMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -122,6 +143,12 @@ AMauriSkateCharacter::AMauriSkateCharacter()
 	SkateMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("SkateMesh"));
 	SkateMesh->SetupAttachment(GetCapsuleComponent());
 
+	// the board follows the floor under its wheels
+	BoardAlignment = CreateDefaultSubobject<USkateBoardAlignmentComponent>(TEXT("BoardAlignment"));
+
+	// every run the player skates is recorded, the ones that get submitted keep their ghost
+	GhostRecorder = CreateDefaultSubobject<USkateGhostRecorderComponent>(TEXT("GhostRecorder"));
+
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named ThirdPersonCharacter (to avoid direct content references in C++)
 }
@@ -167,9 +194,9 @@ void AMauriSkateCharacter::Push(const FInputActionValue& Value)
 {
 	bool ActionValue = Value.Get<bool>();
 	
-	if (SkatePushRemainingTime <= 0.0 && !IsJumpingNow())
+	if (!IsPushingNow() && !IsJumpingNow())
 	{
-		SkatePushRemainingTime = SkatePushAnimationDuration;
+		GetSkateMovement()->RequestSkatePush();
 	}
 }
 
@@ -204,55 +231,25 @@ void AMauriSkateCharacter::DoTurn(float Right, float Forward)
 	if (GetController() != nullptr && !IsJumpingNow())
 	{
 
-		const FRotator InitialRotation = GetCharacterMovement()->UpdatedComponent->GetComponentRotation();
-		const FRotator InitialYawRotation(0,InitialRotation.Yaw,0);
-		const FVector InitialForwardDirection = FRotationMatrix(InitialYawRotation).GetUnitAxis(EAxis::X);
-		
 		const FRotator ControllerRotation = GetController()->GetControlRotation();
 		const FRotator ControllerYawRotation(0, ControllerRotation.Yaw, 0);
 		const FVector TargetForwardDirection = FRotationMatrix(ControllerYawRotation).GetUnitAxis(EAxis::X);
 		const FVector TargetRightDirection = FRotationMatrix(ControllerYawRotation).GetUnitAxis(EAxis::Y);
 		const FVector TargetFinalDirection = (TargetForwardDirection*Forward + TargetRightDirection*Right).GetSafeNormal(0.001);
-		const FRotator TargetRotator = TargetFinalDirection.Rotation();
-
-		// RInterpConstantTo uses Degrees
-		// RInterpTo uses a relative measure
-		const FRotator NewRotation = FMath::RInterpConstantTo(InitialYawRotation,TargetRotator,UGameplayStatics::GetWorldDeltaSeconds(this),SkateRelativeTurningSpeed*360);
 
-		// Rotating the pawn
-		GetCharacterMovement()->MoveUpdatedComponent(FVector::ZeroVector,NewRotation,false);
-		
-		// Updating the velocity Direction
-		const FVector OldHorizontalVelocity = GetCharacterMovement()->Velocity * FVector(1.0,1.0,0.0);
-		const FVector OldVerticalVelocity = GetCharacterMovement()->Velocity * FVector(0.0,0.0,1.0);
-		const float OldHorizontalSpeed = OldHorizontalVelocity.Length();
-		const FVector NewVelocity = FRotationMatrix(NewRotation).GetUnitAxis(EAxis::X)*OldHorizontalSpeed + OldVerticalVelocity;
-		GetCharacterMovement()->Velocity = NewVelocity;
-		
+		// The movement component combines this frame's samples and turns once during its own update
+		GetSkateMovement()->AddSkateTurnInput(TargetFinalDirection);
 	}
 }
 
 void AMauriSkateCharacter::DoPush(float Factor)
 {
-	GEngine->AddOnScreenDebugMessage(-1,15.0f,FColor::Magenta, TEXT("Added Push"));
 	if (GetController() != nullptr)
 	{
-		// find out which way is forward
-		const FRotator Rotation = GetActorRotation();
-		const FRotator YawRotation(0, Rotation.Yaw, 0);
-
-		// get forward vector
-		const FVector ForwardDirection = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
-
-		// get right vector 
-		const FVector RightDirection = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
+		SKATE_TRACE_IMPULSE(this, Factor, GetVelocity().Size2D());
 
-		// add movement
-
-		GetCharacterMovement()->AddImpulse(ForwardDirection*SkatePushForce*Factor);
-		//AddMovementInput(ForwardDirection, Forward);
-		//AddMovementInput(RightDirection, Right);
-		
+		// the impulse is applied along the board's forward direction on the next skating substep
+		GetSkateMovement()->AddSkatePush(Factor);
 	}
 }
 
@@ -260,14 +257,14 @@ void AMauriSkateCharacter::DoSlowDown(const bool Pressed)
 {
 	if (Pressed)
 	{
-		GEngine->AddOnScreenDebugMessage(-1,15.0f,FColor::Magenta, TEXT("Slow down started"));
-		GetCharacterMovement()->GroundFriction = SkateSlowDownFriction;
+		SKATE_TRACE_SLOW_DOWN(this, true);
+		GetSkateMovement()->SetSkateSlowingDown(true);
 		bIsSlowingDown = true;
 		
 	} else
 	{
-		GEngine->AddOnScreenDebugMessage(-1,15.0f,FColor::Magenta, TEXT("SlowDown ended"));
-		GetCharacterMovement()->GroundFriction = SkateFloorFriction;
+		SKATE_TRACE_SLOW_DOWN(this, false);
+		GetSkateMovement()->SetSkateSlowingDown(false);
 		bIsSlowingDown = false;
 	}
 }
@@ -297,7 +294,7 @@ void AMauriSkateCharacter::DoJumpEnd()
 
 bool AMauriSkateCharacter::IsPushingNow() const
 {
-	return (SkatePushRemainingTime > 0.0);
+	return GetSkateMovement()->IsSkatePushing();
 }
 
 bool AMauriSkateCharacter::IsJumpingNow() const
@@ -310,25 +307,250 @@ void AMauriSkateCharacter::AddSkateImpulse(float ImpulseIntensity)
 	PendingSolvingSkateForce += ImpulseIntensity;
 }
 
-void AMauriSkateCharacter::SetSkateAlternativeMaterial(const bool SetAlternative)
+ESkateBoardState AMauriSkateCharacter::ComputeSkateBoardState() const
 {
-	if (SetAlternative)
+	if (bIsJumping)
 	{
-		SkateMesh->SetMaterial(0,SkateExecutingMaterial);
-	} else
+		return ESkateBoardState::Airborne;
+	}
+
+	if (bIsPushing)
 	{
-		SkateMesh->SetMaterial(0,SkateReadyMaterial);
+		return ESkateBoardState::Pushing;
+	}
+
+	if (bIsSlowingDown)
+	{
+		return ESkateBoardState::SlowingDown;
+	}
+
+	return ESkateBoardState::Ready;
+}
+
+void AMauriSkateCharacter::SetSkateBoardState(const ESkateBoardState NewState)
+{
+	if (NewState == SkateBoardState)
+	{
+		return;
+	}
+
+	const ESkateBoardState PreviousState = SkateBoardState;
+	SkateBoardState = NewState;
+
+	ApplySkateBoardVisuals();
+
+	OnSkateBoardStateChanged.Broadcast(PreviousState, NewState);
+}
+
+void AMauriSkateCharacter::ApplySkateBoardVisuals()
+{
+	if (SkateMaterialInstance)
+	{
+		SkateMaterialInstance->SetScalarParameterValue(SkateStateMaterialParameter, static_cast<float>(SkateBoardState));
+	}
+	else
+	{
+		// any action in progress shows the executing material
+		SkateMesh->SetMaterial(0, SkateBoardState == ESkateBoardState::Ready ? SkateReadyMaterial : SkateExecutingMaterial);
 	}
-	
 }
 
 void AMauriSkateCharacter::KillCharacter()
 {
+	if (bIsRagdoll)
+	{
+		return;
+	}
+
+	SKATE_TRACE_DEATH(this, GetActorLocation());
+
 	GetMesh()->SetCollisionProfileName("Ragdoll");
 	GetMesh()->SetAllBodiesSimulatePhysics(true);
+	GetMesh()->SetAllBodiesPhysicsBlendWeight(1.0f);
 	SkateMesh->SetSimulatePhysics(true);
+
+	// the capsule waits where the crash happened until we recover
 	GetMovementComponent()->Velocity = FVector::Zero();
+	GetCharacterMovement()->DisableMovement();
+
+	bIsRagdoll = true;
+	RagdollElapsedTime = 0.0f;
+	RecoveryElapsedTime = -1.0f;
+
+	if (USkateRagdollBudgetSubsystem* RagdollBudget = GetWorld()->GetSubsystem<USkateRagdollBudgetSubsystem>())
+	{
+		RagdollBudget->AcquireRagdoll(this);
+	}
+
+	// the crash ends the run, it goes to the leaderboard with what it scored and its ghost
+	FString GhostRunName;
+	if (GhostRecorder->IsRecording())
+	{
+		GhostRecorder->StopRecording();
+		GhostRunName = GhostRecorder->GetRunName();
+	}
+
+	if (UGamePointsComponent* Points = UGamePointsComponent::FindForPawn(this))
+	{
+		Points->FinishRun(GhostRunName);
+	}
+}
+
+void AMauriSkateCharacter::RecoverFromCrash()
+{
+	if (!bIsRagdoll || RecoveryElapsedTime >= 0.0f)
+	{
+		return;
+	}
+
+	// stand up under the ragdoll, on whatever floor it's lying on
+	const FVector RagdollLocation = GetMesh()->GetBoneLocation(RagdollRootBone);
+	const float HalfHeight = GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	FVector RecoverLocation = RagdollLocation + FVector(0.0f, 0.0f, HalfHeight);
+
+	FHitResult FloorHit;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SkateCrashRecovery), false, this);
+	if (GetWorld()->LineTraceSingleByChannel(FloorHit, RagdollLocation + FVector(0.0f, 0.0f, HalfHeight), RagdollLocation - FVector(0.0f, 0.0f, HalfHeight * 2.0f), ECC_Visibility, QueryParams))
+	{
+		RecoverLocation = FloorHit.ImpactPoint + FVector(0.0f, 0.0f, HalfHeight);
+	}
+
+	SetActorLocation(RecoverLocation, false, nullptr, ETeleportType::TeleportPhysics);
+
+	// the body keeps simulating while its weight fades, so the pose blends back to the animation in place
+	GetMesh()->WakeAllRigidBodies();
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	GetMesh()->SetRelativeTransform(ResetSnapshot.MeshRelativeTransform);
+
+	AttachSkateMesh();
+
+	// still simulating while the blend runs, so the ragdoll keeps its place in the budget until ExitRagdoll
+	RecoveryElapsedTime = 0.0f;
+}
+
+void AMauriSkateCharacter::SleepRagdoll()
+{
+	GetMesh()->PutAllRigidBodiesToSleep();
+	SkateMesh->PutAllRigidBodiesToSleep();
 }
 
+bool AMauriSkateCharacter::IsRagdollAwake() const
+{
+	return bIsRagdoll && (GetMesh()->IsAnyRigidBodyAwake() || SkateMesh->IsAnyRigidBodyAwake());
+}
+
+void AMauriSkateCharacter::UpdateRagdoll(float DeltaSeconds)
+{
+	RagdollElapsedTime += DeltaSeconds;
+
+	if (RecoveryElapsedTime < 0.0f)
+	{
+		if (bRecoverAfterCrash && RagdollElapsedTime >= CrashRecoveryDelay)
+		{
+			RecoverFromCrash();
+		}
 
+		return;
+	}
 
+	RecoveryElapsedTime += DeltaSeconds;
+
+	const float Alpha = CrashRecoveryBlendTime > 0.0f ? FMath::Clamp(RecoveryElapsedTime / CrashRecoveryBlendTime, 0.0f, 1.0f) : 1.0f;
+	if (Alpha < 1.0f)
+	{
+		GetMesh()->SetAllBodiesPhysicsBlendWeight(1.0f - Alpha);
+		return;
+	}
+
+	// fully animated again, back on the board where we stand
+	ExitRagdoll();
+	GetSkateMovement()->ResetSkateState(FVector::ZeroVector);
+
+	if (UObstacleWorldSubsystem* Obstacles = GetWorld()->GetSubsystem<UObstacleWorldSubsystem>())
+	{
+		Obstacles->ResetSkater(this);
+	}
+
+	// the crash submitted the last run, skating on is a new one
+	if (UGamePointsComponent* Points = UGamePointsComponent::FindForPawn(this))
+	{
+		Points->StartRun();
+	}
+
+	StartGhostRun();
+}
+
+void AMauriSkateCharacter::CaptureResetState()
+{
+	ResetSnapshot.ActorTransform = GetActorTransform();
+	ResetSnapshot.Velocity = GetVelocity();
+	ResetSnapshot.ControlRotation = GetController() ? GetController()->GetControlRotation() : GetActorRotation();
+	ResetSnapshot.MeshRelativeTransform = GetMesh()->GetRelativeTransform();
+	ResetSnapshot.SkateMeshRelativeTransform = SkateMesh->GetRelativeTransform();
+	ResetSnapshot.MeshCollisionProfile = GetMesh()->GetCollisionProfileName();
+}
+
+void AMauriSkateCharacter::RestoreResetState()
+{
+	if (bIsRagdoll)
+	{
+		ExitRagdoll();
+	}
+
+	SetActorTransform(ResetSnapshot.ActorTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	if (GetController())
+	{
+		GetController()->SetControlRotation(ResetSnapshot.ControlRotation);
+	}
+
+	GetSkateMovement()->ResetSkateState(ResetSnapshot.Velocity);
+
+	// the teleport isn't a move through the level, so it can't clear or hit any obstacle
+	if (UObstacleWorldSubsystem* Obstacles = GetWorld()->GetSubsystem<UObstacleWorldSubsystem>())
+	{
+		Obstacles->ResetSkater(this);
+	}
+
+	bIsSlowingDown = false;
+	PendingSolvingSkateForce = 0.0;
+	bIsJumping = IsJumpingNow();
+	bIsPushing = IsPushingNow();
+	SetSkateBoardState(ComputeSkateBoardState());
+
+	// the run in progress is abandoned, its ghost goes with it
+	GhostRecorder->DiscardRecording();
+	StartGhostRun();
+}
+
+void AMauriSkateCharacter::AttachSkateMesh()
+{
+	// simulating detached the board from the capsule
+	SkateMesh->SetSimulatePhysics(false);
+	SkateMesh->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	SkateMesh->SetRelativeTransform(ResetSnapshot.SkateMeshRelativeTransform, false, nullptr, ETeleportType::ResetPhysics);
+}
+
+void AMauriSkateCharacter::ExitRagdoll()
+{
+	GetMesh()->SetAllBodiesSimulatePhysics(false);
+	GetMesh()->SetCollisionProfileName(ResetSnapshot.MeshCollisionProfile);
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	GetMesh()->SetRelativeTransform(ResetSnapshot.MeshRelativeTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	AttachSkateMesh();
+
+	if (USkateRagdollBudgetSubsystem* RagdollBudget = GetWorld()->GetSubsystem<USkateRagdollBudgetSubsystem>())
+	{
+		RagdollBudget->ReleaseRagdoll(this);
+	}
+
+	bIsRagdoll = false;
+	RecoveryElapsedTime = -1.0f;
+}
+
+UMauriSkateMovementComponent* AMauriSkateCharacter::GetSkateMovement() const
+{
+	return CastChecked<UMauriSkateMovementComponent>(GetCharacterMovement());
+}
@@ -6,22 +6,38 @@
 #include "GameFramework/Character.h"
 #include "Components/StaticMeshComponent.h"
 #include "Logging/LogMacros.h"
+#include "SkateResetSubsystem.h"
 #include "MauriSkateCharacter.generated.h"
 
 class USpringArmComponent;
 class UCameraComponent;
 class UStaticMeshComponent;
+class UMauriSkateMovementComponent;
+class USkateBoardAlignmentComponent;
+class USkateGhostRecorderComponent;
 class UInputAction;
 struct FInputActionValue;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
 
+/** Visual state of the skateboard */
+UENUM(BlueprintType)
+enum class ESkateBoardState : uint8
+{
+	Ready,
+	Pushing,
+	Airborne,
+	SlowingDown
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSkateBoardStateChanged, ESkateBoardState, PreviousState, ESkateBoardState, NewState);
+
 /**
  *  A simple player-controllable third person character
  *  Implements a controllable orbiting camera
  */
 UCLASS(abstract, meta = (PrioritizeCategories ="Skate"))
-class AMauriSkateCharacter : public ACharacter
+class AMauriSkateCharacter : public ACharacter, public ISkateResettable
 {
 	GENERATED_BODY()
 
@@ -36,7 +52,21 @@ class AMauriSkateCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
 	UStaticMeshComponent* SkateMesh;
 
+	/** Tilts the board to the floor under its wheels */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	USkateBoardAlignmentComponent* BoardAlignment;
+
+	/** Records the player's runs for ghost playback */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	USkateGhostRecorderComponent* GhostRecorder;
+
 	virtual void Tick(float DeltaSeconds) override;
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void NotifyControllerChanged() override;
 	
 protected:
 	
@@ -61,7 +91,7 @@ protected:
 public:
 
 	/** Constructor */
-	AMauriSkateCharacter();	
+	AMauriSkateCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
 
@@ -129,23 +159,107 @@ public: // Editable skate animation parameters
 	UMaterialInterface *SkateReadyMaterial;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Skate")
 	UMaterialInterface *SkateExecutingMaterial;
+
+	// If set, the board uses a dynamic instance of SkateReadyMaterial and this scalar parameter
+	// receives the ESkateBoardState value, instead of swapping between the two materials
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Skate")
+	FName SkateStateMaterialParameter = NAME_None;
+
+	// Crashed skaters get back on the board by themselves after a while
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Skate|Crash")
+	bool bRecoverAfterCrash = true;
+
+	// Time spent as a ragdoll before recovering
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Skate|Crash", meta = (ClampMin = 0, Units = "s", EditCondition = "bRecoverAfterCrash"))
+	float CrashRecoveryDelay = 2.0f;
+
+	// Time the body takes to blend from the ragdoll back to the animated pose
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Skate|Crash", meta = (ClampMin = 0, Units = "s"))
+	float CrashRecoveryBlendTime = 0.5f;
+
+	// Bone the capsule is moved under when recovering
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Skate|Crash")
+	FName RagdollRootBone = TEXT("pelvis");
+
+	// Broadcast only when the board's visual state actually changes
+	UPROPERTY(BlueprintAssignable, Category = "Skate")
+	FOnSkateBoardStateChanged OnSkateBoardStateChanged;
+
+	UFUNCTION(BlueprintPure, Category = "Skate")
+	ESkateBoardState GetSkateBoardState() const { return SkateBoardState; }
 	
 	bool IsPushingNow() const;
 	bool IsJumpingNow() const;
 
 	void KillCharacter();
 
-private: // Inner Working skate state variables
-	float SkatePushRemainingTime = 0.0;
-	bool bPushingInstantReached = false;
+	// Gets back on the board where the ragdoll ended up, blending the body back to the animation
+	UFUNCTION(BlueprintCallable, Category = "Skate|Crash")
+	void RecoverFromCrash();
 
+	// Stops the ragdoll from costing physics time until something wakes it up. Called by the USkateRagdollBudgetSubsystem
+	void SleepRagdoll();
+
+	// True while in ragdoll with any body simulating, including one woken up by a contact after SleepRagdoll
+	bool IsRagdollAwake() const;
+
+	UFUNCTION(BlueprintPure, Category = "Skate|Crash")
+	bool IsRagdoll() const { return bIsRagdoll; }
+
+	// ~begin ISkateResettable interface
+	virtual void CaptureResetState() override;
+	virtual void RestoreResetState() override;
+	// ~end ISkateResettable interface
+
+private: // Inner Working skate state variables
 	float PendingSolvingSkateForce = 0.0;
 
 	bool bIsSlowingDown = false;
+
+	ESkateBoardState SkateBoardState = ESkateBoardState::Ready;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UMaterialInstanceDynamic> SkateMaterialInstance;
+
+	/** State the character goes back to on a world reset */
+	struct FSkateResetSnapshot
+	{
+		FTransform ActorTransform;
+		FVector Velocity = FVector::ZeroVector;
+		FRotator ControlRotation = FRotator::ZeroRotator;
+		FTransform MeshRelativeTransform;
+		FTransform SkateMeshRelativeTransform;
+		FName MeshCollisionProfile;
+	};
+
+	FSkateResetSnapshot ResetSnapshot;
+
+	// True from KillCharacter until the ragdoll is undone
+	bool bIsRagdoll = false;
+
+	// Time since the crash, and since the recovery blend started, or negative while still a ragdoll
+	float RagdollElapsedTime = 0.0f;
+	float RecoveryElapsedTime = -1.0f;
+
+	/** Advances the crash timer and the recovery blend */
+	void UpdateRagdoll(float DeltaSeconds);
+
+	/** Puts the board back on the capsule */
+	void AttachSkateMesh();
+
+	/** Stops simulating the body and the board and puts them back on the capsule */
+	void ExitRagdoll();
+
+	/** Starts recording a new ghost run, for locally controlled players only */
+	void StartGhostRun();
 	
 	void AddSkateImpulse(float ImpulseIntensity);
 
-	void SetSkateAlternativeMaterial(const bool SetAlternative);
+	ESkateBoardState ComputeSkateBoardState() const;
+
+	void SetSkateBoardState(const ESkateBoardState NewState);
+
+	void ApplySkateBoardVisuals();
 
 
 public:
@@ -155,5 +269,11 @@ public:
 
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
+
+	/** Returns the board alignment component **/
+	FORCEINLINE USkateBoardAlignmentComponent* GetBoardAlignment() const { return BoardAlignment; }
+
+	/** Returns the skate movement component **/
+	UMauriSkateMovementComponent* GetSkateMovement() const;
 };
 
@@ -0,0 +1,919 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MauriSkateMovementComponent.h"
+#include "MauriSkateCharacter.h"
+#include "SkateTelemetry.h"
+#include "Components/CapsuleComponent.h"
+#include "Curves/CurveFloat.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "GameFramework/Controller.h"
+#include "Engine/World.h"
+
+void FSavedMove_Skate::Clear()
+{
+	Super::Clear();
+
+	bSavedPushRequested = false;
+	bSavedSlowingDown = false;
+	bSavedHasTurnTarget = false;
+	SavedTurnTargetYaw = 0.0f;
+	SavedUpcomingSlope = FSkateUpcomingSlope();
+}
+
+uint8 FSavedMove_Skate::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+
+	if (bSavedPushRequested)
+	{
+		Result |= FLAG_Custom_0;
+	}
+
+	if (bSavedSlowingDown)
+	{
+		Result |= FLAG_Custom_1;
+	}
+
+	if (bSavedHasTurnTarget)
+	{
+		Result |= FLAG_Custom_2;
+	}
+
+	return Result;
+}
+
+bool FSavedMove_Skate::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_Skate* NewSkateMove = static_cast<const FSavedMove_Skate*>(NewMove.Get());
+
+	// never merge away a push or a change in the skate input
+	if (bSavedPushRequested || NewSkateMove->bSavedPushRequested ||
+		bSavedSlowingDown != NewSkateMove->bSavedSlowingDown ||
+		bSavedHasTurnTarget != NewSkateMove->bSavedHasTurnTarget ||
+		SavedTurnTargetYaw != NewSkateMove->SavedTurnTargetYaw)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_Skate::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	if (const UMauriSkateMovementComponent* SkateMovement = Cast<UMauriSkateMovementComponent>(C->GetCharacterMovement()))
+	{
+		bSavedPushRequested = SkateMovement->IsSkatePushRequested();
+		bSavedSlowingDown = SkateMovement->IsSkateSlowingDown();
+		bSavedHasTurnTarget = SkateMovement->HasSkateTurnTarget();
+		SavedTurnTargetYaw = SkateMovement->GetSkateTurnTarget().Yaw;
+		SavedUpcomingSlope = SkateMovement->GetUpcomingSkateSlope();
+	}
+}
+
+void FSavedMove_Skate::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	// the flags are restored through UpdateFromCompressedFlags, only the yaw and the slope ahead need to be put back here
+	if (UMauriSkateMovementComponent* SkateMovement = Cast<UMauriSkateMovementComponent>(C->GetCharacterMovement()))
+	{
+		SkateMovement->SetSkateTurnTarget(FRotator(0.0f, SavedTurnTargetYaw, 0.0f));
+		SkateMovement->SetUpcomingSkateSlope(SavedUpcomingSlope);
+	}
+}
+
+////////////////////////////////////////////////////////////////////
+
+FNetworkPredictionData_Client_Skate::FNetworkPredictionData_Client_Skate(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Skate::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Skate());
+}
+
+////////////////////////////////////////////////////////////////////
+
+void FSkateNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	Super::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+	const FSavedMove_Skate& SkateMove = static_cast<const FSavedMove_Skate&>(ClientMove);
+	CompressedTurnTargetYaw = FRotator::CompressAxisToShort(SkateMove.SavedTurnTargetYaw);
+}
+
+bool FSkateNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	Super::Serialize(CharacterMovement, Ar, PackageMap, MoveType);
+
+	// the yaw only goes over the wire on moves that are turning
+	if (CompressedMoveFlags & FSavedMove_Character::FLAG_Custom_2)
+	{
+		Ar << CompressedTurnTargetYaw;
+	}
+
+	return !Ar.IsError();
+}
+
+FSkateNetworkMoveDataContainer::FSkateNetworkMoveDataContainer()
+{
+	NewMoveData = &SkateMoveData[0];
+	PendingMoveData = &SkateMoveData[1];
+	OldMoveData = &SkateMoveData[2];
+}
+
+////////////////////////////////////////////////////////////////////
+
+void FSkateMoveResponseDataContainer::ServerFillResponseData(const UCharacterMovementComponent& CharacterMovement, const FClientAdjustment& PendingAdjustment)
+{
+	Super::ServerFillResponseData(CharacterMovement, PendingAdjustment);
+
+	const UMauriSkateMovementComponent& SkateMovement = static_cast<const UMauriSkateMovementComponent&>(CharacterMovement);
+	PushRemainingTime = SkateMovement.GetSkateSimState().PushRemainingTime;
+	bPushingInstantReached = SkateMovement.GetSkateSimState().bPushingInstantReached;
+	SimAccumulator = static_cast<float>(SkateMovement.GetSkateSimAccumulator().Accumulator);
+}
+
+bool FSkateMoveResponseDataContainer::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap)
+{
+	if (!Super::Serialize(CharacterMovement, Ar, PackageMap))
+	{
+		return false;
+	}
+
+	// good moves stay small, only corrections carry the skate state
+	if (IsCorrection())
+	{
+		Ar << PushRemainingTime;
+		Ar.SerializeBits(&bPushingInstantReached, 1);
+		Ar << SimAccumulator;
+	}
+
+	return !Ar.IsError();
+}
+
+////////////////////////////////////////////////////////////////////
+
+UMauriSkateMovementComponent::UMauriSkateMovementComponent()
+{
+	// the skate owns its rotation, the component shouldn't try to orient it
+	bOrientRotationToMovement = false;
+	bUseControllerDesiredRotation = false;
+
+	// send and receive the skate input and state along with the character moves
+	SetNetworkMoveDataContainer(SkateNetworkMoveDataContainer);
+	SetMoveResponseDataContainer(SkateMoveResponseDataContainer);
+
+	SkateRampProbeDelegate.BindUObject(this, &UMauriSkateMovementComponent::OnSkateRampProbeDone);
+}
+
+void UMauriSkateMovementComponent::RequestSkatePush()
+{
+	bSkatePushRequested = true;
+}
+
+void UMauriSkateMovementComponent::AddSkatePush(float Factor)
+{
+	PendingSkatePush += Factor;
+}
+
+void UMauriSkateMovementComponent::SetSkateTurnTarget(const FRotator& TargetRotation)
+{
+	// quantize the yaw the same way the network does, so the client predicts what the server will simulate
+	SkateTurnTarget = FRotator(0.0f, FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(TargetRotation.Yaw)), 0.0f);
+	bHasSkateTurnTarget = true;
+}
+
+void UMauriSkateMovementComponent::AddSkateTurnInput(const FVector& Direction)
+{
+	const FVector HorizontalDirection = Direction.GetSafeNormal2D();
+
+	// no stick input, no turn
+	if (HorizontalDirection.IsZero())
+	{
+		return;
+	}
+
+	// all of a frame's samples arrive in the same input pass, with nothing to tell them apart in time,
+	// so the latest one, where the stick is now, is the one we turn towards
+	PendingSkateTurnDirection = HorizontalDirection;
+	bHasPendingSkateTurn = true;
+}
+
+void UMauriSkateMovementComponent::FlushSkateTurnInput()
+{
+	if (!bHasPendingSkateTurn)
+	{
+		return;
+	}
+
+	SetSkateTurnTarget(PendingSkateTurnDirection.Rotation());
+
+	bHasPendingSkateTurn = false;
+}
+
+void UMauriSkateMovementComponent::SetSkateSlowingDown(bool bSlowingDown)
+{
+	bIsSkateSlowingDown = bSlowingDown;
+}
+
+bool UMauriSkateMovementComponent::IsSkatePushing() const
+{
+	return SkateSimState.IsPushing() || bSkatePushRequested;
+}
+
+bool UMauriSkateMovementComponent::IsSkating() const
+{
+	return MovementMode == MOVE_Custom && CustomMovementMode == static_cast<uint8>(ESkateMovementMode::Skating) && UpdatedComponent;
+}
+
+void UMauriSkateMovementComponent::AddSkatePresentationComponent(USceneComponent* Component, bool bIsBoard)
+{
+	if (Component)
+	{
+		SkatePresentationComponents.Add({ Component, Component->GetRelativeTransform(), bIsBoard });
+	}
+}
+
+void UMauriSkateMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	BuildSkateSurfaceRecords();
+}
+
+void UMauriSkateMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	// resolve this frame's turn input before the move is saved and simulated, so it turns once per frame
+	FlushSkateTurnInput();
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	FSkateMovementCounters::MovementCycles += FPlatformTime::Cycles64() - StartCycles;
+
+	// probe from where this frame's movement left us
+	IssueSkateRampProbe();
+}
+
+void UMauriSkateMovementComponent::ComputeFloorDist(const FVector& CapsuleLocation, float LineDistance, float SweepDistance, FFindFloorResult& OutFloorResult, float SweepRadius, const FHitResult* DownwardSweepResult) const
+{
+	++FSkateMovementCounters::FloorQueries;
+
+	Super::ComputeFloorDist(CapsuleLocation, LineDistance, SweepDistance, OutFloorResult, SweepRadius, DownwardSweepResult);
+}
+
+bool UMauriSkateMovementComponent::MoveUpdatedComponentImpl(const FVector& Delta, const FQuat& NewRotation, bool bSweep, FHitResult* OutHit, ETeleportType Teleport)
+{
+	if (bSweep)
+	{
+		++FSkateMovementCounters::MoveSweeps;
+	}
+
+	return Super::MoveUpdatedComponentImpl(Delta, NewRotation, bSweep, OutHit, Teleport);
+}
+
+void UMauriSkateMovementComponent::SetUpdatedComponent(USceneComponent* NewUpdatedComponent)
+{
+	Super::SetUpdatedComponent(NewUpdatedComponent);
+
+	SkateCharacterOwner = Cast<AMauriSkateCharacter>(CharacterOwner);
+}
+
+FNetworkPredictionData_Client* UMauriSkateMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UMauriSkateMovementComponent* MutableThis = const_cast<UMauriSkateMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Skate(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+bool UMauriSkateMovementComponent::IsMovingOnGround() const
+{
+	// skating counts as ground movement for jumping, floor checks and animation
+	return Super::IsMovingOnGround() || IsSkating();
+}
+
+float UMauriSkateMovementComponent::GetMaxSpeed() const
+{
+	if (IsSkating() && SkateCharacterOwner)
+	{
+		return SkateCharacterOwner->MaxSkateHorizontalVelocity;
+	}
+
+	return Super::GetMaxSpeed();
+}
+
+void UMauriSkateMovementComponent::ResetSkateState(const FVector& InVelocity)
+{
+	bSkatePushRequested = false;
+	PendingSkatePush = 0.0f;
+	bHasSkateTurnTarget = false;
+	bIsSkateSlowingDown = false;
+	bHasPendingSkateTurn = false;
+	UpcomingSkateSlope.bValid = false;
+	ProbedSkateSlope.bValid = false;
+
+	Velocity = InVelocity;
+	SetDefaultMovementMode();
+
+	// same as starting a new stretch of skating, even if we never left the mode
+	SkateSimAccumulator.Reset();
+	SkateSimState = FSkateSimState();
+	SkateSimState.Location = UpdatedComponent->GetComponentLocation();
+	SkateSimState.Velocity = Velocity;
+	SkateSimState.Yaw = UpdatedComponent->GetComponentRotation().Yaw;
+	PreviousSkateSimState = SkateSimState;
+	SkateTurnTarget = FRotator(0.0f, SkateSimState.Yaw, 0.0f);
+}
+
+void UMauriSkateMovementComponent::SetDefaultMovementMode()
+{
+	Super::SetDefaultMovementMode();
+
+	// skate characters replace walking with skating
+	if (SkateCharacterOwner && MovementMode == MOVE_Walking)
+	{
+		SetMovementMode(MOVE_Custom, static_cast<uint8>(ESkateMovementMode::Skating));
+	}
+}
+
+void UMauriSkateMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	// every stretch of skating starts with a fresh clock
+	SkateSimAccumulator.Reset();
+
+	if (IsSkating())
+	{
+		SkateSimState.Location = UpdatedComponent->GetComponentLocation();
+		SkateSimState.Velocity = Velocity;
+		SkateSimState.Yaw = UpdatedComponent->GetComponentRotation().Yaw;
+		PreviousSkateSimState = SkateSimState;
+	}
+	else
+	{
+		// cancels pushing if we start to be in the air
+		SkateSimState.PushRemainingTime = 0.0f;
+		SkateSimState.bPushingInstantReached = false;
+		bSkatePushRequested = false;
+		PendingSkatePush = 0.0f;
+		UpcomingSkateSlope.bValid = false;
+		ProbedSkateSlope.bValid = false;
+	}
+}
+
+void UMauriSkateMovementComponent::SetPostLandedPhysics(const FHitResult& Hit)
+{
+	Super::SetPostLandedPhysics(Hit);
+
+	// land back on the board
+	if (SkateCharacterOwner && MovementMode == MOVE_Walking)
+	{
+		SetMovementMode(MOVE_Custom, static_cast<uint8>(ESkateMovementMode::Skating));
+	}
+}
+
+void UMauriSkateMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	switch (static_cast<ESkateMovementMode>(CustomMovementMode))
+	{
+	case ESkateMovementMode::Skating:
+		PhysSkating(deltaTime, Iterations);
+		break;
+
+	default:
+		Super::PhysCustom(deltaTime, Iterations);
+		break;
+	}
+}
+
+void UMauriSkateMovementComponent::OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity)
+{
+	Super::OnMovementUpdated(DeltaSeconds, OldLocation, OldVelocity);
+
+	// turn input lasts until a simulation step has used it
+	if (bSkateStepRanThisUpdate)
+	{
+		bHasSkateTurnTarget = false;
+	}
+
+	bSkateStepRanThisUpdate = false;
+
+	ApplySkatePresentation();
+}
+
+void UMauriSkateMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	// a push request survives until a step consumes it
+	if (Flags & FSavedMove_Character::FLAG_Custom_0)
+	{
+		bSkatePushRequested = true;
+	}
+
+	bIsSkateSlowingDown = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+	bHasSkateTurnTarget = (Flags & FSavedMove_Character::FLAG_Custom_2) != 0;
+}
+
+void UMauriSkateMovementComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	// on the server, pick up the turn target sent along with the move
+	if (const FSkateNetworkMoveData* MoveData = static_cast<const FSkateNetworkMoveData*>(GetCurrentNetworkMoveData()))
+	{
+		SkateTurnTarget = FRotator(0.0f, FRotator::DecompressAxisFromShort(MoveData->CompressedTurnTargetYaw), 0.0f);
+	}
+
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+}
+
+void UMauriSkateMovementComponent::OnClientCorrectionReceived(FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode, FVector ServerGravityDirection)
+{
+	Super::OnClientCorrectionReceived(ClientData, TimeStamp, NewLocation, NewVelocity, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode, ServerGravityDirection);
+
+	// rewind the skate simulation to the server's state, the saved moves are replayed on top of it
+	const FSkateMoveResponseDataContainer& ResponseData = static_cast<const FSkateMoveResponseDataContainer&>(GetMoveResponseDataContainer());
+	SkateSimState.PushRemainingTime = ResponseData.PushRemainingTime;
+	SkateSimState.bPushingInstantReached = ResponseData.bPushingInstantReached;
+	SkateSimAccumulator.Accumulator = ResponseData.SimAccumulator;
+	bSkatePushRequested = false;
+}
+
+void UMauriSkateMovementComponent::PhysSkating(float deltaTime, int32 Iterations)
+{
+	if (deltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+
+	if (!CharacterOwner || !SkateCharacterOwner || (!CharacterOwner->Controller && !bRunPhysicsWithNoController && (CharacterOwner->GetLocalRole() != ROLE_SimulatedProxy)))
+	{
+		Acceleration = FVector::ZeroVector;
+		Velocity = FVector::ZeroVector;
+		return;
+	}
+
+	if (!UpdatedComponent->IsQueryCollisionEnabled())
+	{
+		SetMovementMode(MOVE_Walking);
+		return;
+	}
+
+	// the simulation runs at a fixed rate; whatever is left over carries into the next frame
+	SkateSimParams = GatherSkateSimParams();
+	const int32 NumSteps = SkateSimAccumulator.Consume(deltaTime, SkateSimParams);
+	const float TimeTick = SkateSimParams.FixedStep;
+
+	for (int32 Step = 0; Step < NumSteps; ++Step)
+	{
+		if (!CharacterOwner || !(CharacterOwner->Controller || bRunPhysicsWithNoController || (CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy)))
+		{
+			break;
+		}
+
+		Iterations++;
+		bJustTeleported = false;
+		bSkateStepRanThisUpdate = true;
+
+		// save the current values
+		const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+		const FFindFloorResult OldFloor = CurrentFloor;
+
+		// sync the simulation with wherever collision left us
+		SkateSimState.Location = OldLocation;
+		SkateSimState.Velocity = Velocity;
+		SkateSimState.Yaw = UpdatedComponent->GetComponentRotation().Yaw;
+		PreviousSkateSimState = SkateSimState;
+
+		// replays run against the slope saved with the move, only live steps pick up probe results
+		if (!CharacterOwner->bClientUpdating)
+		{
+			UpdateUpcomingSkateSlope();
+		}
+
+		// push, ramp gravity, friction and turning all land in the velocity before we move
+		const FSkateSimStepResult StepResult = FSkateSimStep::Advance(SkateSimState, ConsumeSkateSimInput(), SkateSimParams);
+
+		// replayed moves already reported their events the first time around
+		if (!CharacterOwner->bClientUpdating)
+		{
+			if (StepResult.bPushStarted)
+			{
+				SKATE_TRACE_PUSH(CharacterOwner, SkateSimState.Velocity.Size2D());
+			}
+
+			if (StepResult.bPushImpulseApplied)
+			{
+				SKATE_TRACE_IMPULSE(CharacterOwner, 1.0f, SkateSimState.Velocity.Size2D());
+			}
+		}
+
+		Velocity = SkateSimState.Velocity;
+		const FQuat NewRotation = FRotator(0.0f, SkateSimState.Yaw, 0.0f).Quaternion();
+		const FVector Delta = TimeTick * Velocity;
+
+		// move and rotate the board in one go
+		FStepDownResult StepDownResult;
+		if (!Delta.IsNearlyZero())
+		{
+			MoveSkateAlongFloor(Delta, NewRotation, TimeTick, &StepDownResult);
+		}
+		else if (!UpdatedComponent->GetComponentQuat().Equals(NewRotation))
+		{
+			FHitResult Hit(1.f);
+			SafeMoveUpdatedComponent(FVector::ZeroVector, NewRotation, true, Hit);
+		}
+
+		// update the floor. The step down may have already found it for us
+		if (StepDownResult.bComputedFloor)
+		{
+			CurrentFloor = StepDownResult.FloorResult;
+		}
+		else
+		{
+			FindFloor(UpdatedComponent->GetComponentLocation(), CurrentFloor, false);
+		}
+
+		// rolled off an edge? Hand the rest of the frame over to falling
+		if (!CurrentFloor.IsWalkableFloor() && !CurrentFloor.HitResult.bStartPenetrating)
+		{
+			const FHitResult NoHit(1.f);
+			const float RemainingTime = (NumSteps - Step - 1) * TimeTick;
+			if (CheckFall(OldFloor, NoHit, Delta, OldLocation, RemainingTime, TimeTick, Iterations, false))
+			{
+				return;
+			}
+		}
+
+		// stick to the floor
+		if (CurrentFloor.IsWalkableFloor())
+		{
+			AdjustFloorHeight();
+			SetBaseFromFloor(CurrentFloor);
+		}
+
+		// keep the velocity in line with what the sweep actually allowed
+		if (!bJustTeleported)
+		{
+			Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / TimeTick;
+		}
+
+		MaintainHorizontalGroundVelocity();
+
+		SkateSimState.Location = UpdatedComponent->GetComponentLocation();
+		SkateSimState.Velocity = Velocity;
+	}
+}
+
+FSkateSimParams UMauriSkateMovementComponent::GatherSkateSimParams() const
+{
+	return BuildSkateSimParams(*SkateCharacterOwner, GetGravityZ());
+}
+
+FSkateSimParams UMauriSkateMovementComponent::BuildSkateSimParams(const AMauriSkateCharacter& Character, float InGravityZ) const
+{
+	FSkateSimParams Params;
+	Params.FixedStep = 1.0f / FMath::Max(SkateSimulationRate, 1.0f);
+	Params.MaxStepsPerFrame = MaxSkateStepsPerFrame;
+	Params.PushDuration = Character.SkatePushAnimationDuration;
+	Params.PushInstantNormalized = Character.SkatePushAnimationInstantNormalized;
+	Params.PushVelocityChange = Character.SkatePushForce / FMath::Max(Mass, UE_KINDA_SMALL_NUMBER);
+	Params.MaxHorizontalSpeed = Character.MaxSkateHorizontalVelocity;
+	Params.TurnRate = Character.SkateRelativeTurningSpeed * 360.0f;
+	Params.GravityFactor = Character.SkateGravityFactor;
+	Params.GravityZ = InGravityZ;
+	Params.FloorFriction = Character.SkateFloorFriction;
+	Params.SlowDownFriction = Character.SkateSlowDownFriction;
+	Params.BrakingFrictionFactor = BrakingFrictionFactor;
+
+	return Params;
+}
+
+void UMauriSkateMovementComponent::IssueSkateRampProbe()
+{
+	UWorld* World = GetWorld();
+	if (!bEnableSkateRampProbe || !World || !IsSkating() || !CurrentFloor.IsWalkableFloor())
+	{
+		return;
+	}
+
+	const FVector HorizontalVelocity(Velocity.X, Velocity.Y, 0.0f);
+	if (HorizontalVelocity.IsNearlyZero(1.0f))
+	{
+		return;
+	}
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SkateRampProbe), false, CharacterOwner);
+	FCollisionResponseParams ResponseParams;
+	InitCollisionParams(QueryParams, ResponseParams);
+
+	// trace down from the capsule center at points along the predicted path, so rising ramps are found too
+	const float HalfHeight = CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	const int32 NumSamples = FMath::Max(SkateRampProbeSamples, 1);
+
+	for (int32 Sample = 1; Sample <= NumSamples; ++Sample)
+	{
+		const FVector Start = Location + HorizontalVelocity * (SkateRampProbeLookAheadTime * Sample / NumSamples);
+		const FVector End = Start - FVector::UpVector * (HalfHeight + SkateRampProbeDepth);
+
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, UpdatedComponent->GetCollisionObjectType(), QueryParams, ResponseParams, &SkateRampProbeDelegate);
+	}
+}
+
+void UMauriSkateMovementComponent::OnSkateRampProbeDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	if (!IsSkating() || TraceDatum.OutHits.IsEmpty())
+	{
+		return;
+	}
+
+	const FHitResult& Hit = TraceDatum.OutHits[0];
+	if (!Hit.bBlockingHit || !IsWalkable(Hit))
+	{
+		return;
+	}
+
+	// same slope as the one we're on, nothing to prepare for
+	if ((Hit.ImpactNormal | CurrentFloor.HitResult.ImpactNormal) > 0.999f)
+	{
+		return;
+	}
+
+	// the samples come back one by one, keep the change closest to the board
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	if (!ProbedSkateSlope.bValid || FVector::DistSquared2D(Hit.ImpactPoint, Location) < FVector::DistSquared2D(ProbedSkateSlope.Location, Location))
+	{
+		ProbedSkateSlope.Location = Hit.ImpactPoint;
+		ProbedSkateSlope.Normal = Hit.ImpactNormal;
+		ProbedSkateSlope.bValid = true;
+	}
+}
+
+void UMauriSkateMovementComponent::UpdateUpcomingSkateSlope()
+{
+	// forget the slope once we've reached it, passed it or turned away from it
+	if (UpcomingSkateSlope.bValid && GetUpcomingSkateSlopeDistance() < 0.0f)
+	{
+		UpcomingSkateSlope.bValid = false;
+	}
+
+	// keep the closest change until we reach it, later probes only see further along the ramp
+	if (!UpcomingSkateSlope.bValid && ProbedSkateSlope.bValid)
+	{
+		UpcomingSkateSlope = ProbedSkateSlope;
+	}
+
+	ProbedSkateSlope.bValid = false;
+}
+
+float UMauriSkateMovementComponent::GetUpcomingSkateSlopeDistance() const
+{
+	if (!UpcomingSkateSlope.bValid || !CurrentFloor.IsWalkableFloor())
+	{
+		return -1.0f;
+	}
+
+	const FVector Forward = FVector(Velocity.X, Velocity.Y, 0.0f).GetSafeNormal();
+	const FVector ToSlope3D = UpcomingSkateSlope.Location - UpdatedComponent->GetComponentLocation();
+	const FVector ToSlope(ToSlope3D.X, ToSlope3D.Y, 0.0f);
+	const float Distance = ToSlope | Forward;
+	const float SideDistance = (ToSlope - Forward * Distance).Size();
+
+	const bool bReached = (CurrentFloor.HitResult.ImpactNormal | UpcomingSkateSlope.Normal) > 0.999f;
+	const bool bOffPath = SideDistance > CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleRadius() * 2.0f;
+	if (bReached || bOffPath || Forward.IsZero() || Distance <= 0.0f)
+	{
+		return -1.0f;
+	}
+
+	return Distance;
+}
+
+FVector UMauriSkateMovementComponent::ResolveSkateFloorNormal() const
+{
+	const FVector FloorNormal = CurrentFloor.HitResult.ImpactNormal;
+
+	// only where we are and where the slope is matter here, so a replayed move blends exactly like it did the first time
+	const float Distance = GetUpcomingSkateSlopeDistance();
+	if (Distance < 0.0f)
+	{
+		return FloorNormal;
+	}
+
+	// fade the upcoming slope in as we get closer to it
+	const float Alpha = 1.0f - FMath::Clamp(Distance / SkateRampProbeBlendDistance, 0.0f, 1.0f);
+	return FMath::Lerp(FloorNormal, UpcomingSkateSlope.Normal, Alpha).GetSafeNormal(UE_SMALL_NUMBER, FloorNormal);
+}
+
+FSkateSimInput UMauriSkateMovementComponent::ConsumeSkateSimInput()
+{
+	FSkateSimInput Input;
+	Input.bPushRequested = bSkatePushRequested;
+	Input.PushImpulseFactor = PendingSkatePush;
+	Input.bSlowingDown = bIsSkateSlowingDown;
+	Input.bHasTurnTarget = bHasSkateTurnTarget;
+	Input.TurnTargetYaw = SkateTurnTarget.Yaw;
+	Input.bGrounded = CurrentFloor.IsWalkableFloor();
+	Input.FloorNormal = ResolveSkateFloorNormal();
+
+	// one array index per step, the floor's record only changes with the floor component
+	if (const FSkateSurfaceRecord* Surface = ResolveSkateSurface())
+	{
+		Input.FrictionTable = &Surface->Friction;
+		Input.MaxSpeedScale = Surface->MaxSpeedScale;
+	}
+
+	// one-shot requests only apply to a single step
+	bSkatePushRequested = false;
+	PendingSkatePush = 0.0f;
+
+	return Input;
+}
+
+void UMauriSkateMovementComponent::BuildSkateSurfaceRecords()
+{
+	const auto Sample = [](const UCurveFloat* Curve, float Scale)
+	{
+		return [Curve, Scale](float Speed) { return (Curve ? Curve->GetFloatValue(Speed) : 1.0f) * Scale; };
+	};
+
+	SkateSurfaceRecords.Reset(SkateSurfaceResponses.Num() + 1);
+	SkateSurfaceRecords.AddDefaulted_GetRef().Friction.Bake(SkateFrictionCurveMaxSpeed, Sample(SkateRollingFrictionCurve, 1.0f), Sample(SkateSlowDownFrictionCurve, 1.0f));
+
+	FMemory::Memzero(SkateSurfaceRecordIndices);
+
+	for (const FSkateSurfaceResponse& Response : SkateSurfaceResponses)
+	{
+		SkateSurfaceRecordIndices[Response.Surface] = SkateSurfaceRecords.Num();
+
+		FSkateSurfaceRecord& Record = SkateSurfaceRecords.AddDefaulted_GetRef();
+		Record.Friction.Bake(SkateFrictionCurveMaxSpeed, Sample(Response.RollingFrictionCurve, Response.FrictionScale), Sample(Response.SlowDownFrictionCurve, Response.FrictionScale));
+		Record.MaxSpeedScale = Response.MaxSpeedScale;
+		Record.RollingSound = Response.RollingSound;
+		Record.RollingEffect = Response.RollingEffect;
+	}
+
+	SkateSurfaceFloor.Reset();
+	SkateSurfaceFloorRecord = 0;
+}
+
+const FSkateSurfaceRecord* UMauriSkateMovementComponent::ResolveSkateSurface()
+{
+	if (SkateSurfaceRecords.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	const UPrimitiveComponent* Floor = CurrentFloor.HitResult.Component.Get();
+	if (Floor != SkateSurfaceFloor.Get())
+	{
+		SkateSurfaceFloor = Floor;
+		SkateSurfaceFloorRecord = 0;
+
+		// floor queries don't return physical materials, so ask the floor's body
+		const UPhysicalMaterial* PhysicalMaterial = CurrentFloor.HitResult.PhysMaterial.Get();
+		if (!PhysicalMaterial && Floor)
+		{
+			if (const FBodyInstance* BodyInstance = Floor->GetBodyInstance(CurrentFloor.HitResult.BoneName))
+			{
+				PhysicalMaterial = BodyInstance->GetSimplePhysicalMaterial();
+			}
+		}
+
+		if (PhysicalMaterial)
+		{
+			SkateSurfaceFloorRecord = SkateSurfaceRecordIndices[PhysicalMaterial->SurfaceType];
+		}
+	}
+
+	return &SkateSurfaceRecords[SkateSurfaceFloorRecord];
+}
+
+USoundBase* UMauriSkateMovementComponent::GetSkateSurfaceRollingSound() const
+{
+	return SkateSurfaceRecords.IsValidIndex(SkateSurfaceFloorRecord) ? SkateSurfaceRecords[SkateSurfaceFloorRecord].RollingSound : nullptr;
+}
+
+UFXSystemAsset* UMauriSkateMovementComponent::GetSkateSurfaceRollingEffect() const
+{
+	return SkateSurfaceRecords.IsValidIndex(SkateSurfaceFloorRecord) ? SkateSurfaceRecords[SkateSurfaceFloorRecord].RollingEffect : nullptr;
+}
+
+void UMauriSkateMovementComponent::ApplySkatePresentation()
+{
+	if (SkatePresentationComponents.IsEmpty() || !UpdatedComponent)
+	{
+		return;
+	}
+
+	FVector WorldOffset = FVector::ZeroVector;
+	float YawOffset = 0.0f;
+
+	// simulated proxies are smoothed by the network code instead
+	if (IsSkating() && CharacterOwner && CharacterOwner->GetLocalRole() != ROLE_SimulatedProxy)
+	{
+		const FSkateSimState Presented = FSkateSimState::Interpolate(PreviousSkateSimState, SkateSimState, SkateSimAccumulator.GetAlpha(SkateSimParams));
+		WorldOffset = Presented.Location - UpdatedComponent->GetComponentLocation();
+		YawOffset = FRotator::NormalizeAxis(Presented.Yaw - UpdatedComponent->GetComponentRotation().Yaw);
+	}
+
+	const FVector LocalOffset = UpdatedComponent->GetComponentQuat().UnrotateVector(WorldOffset);
+	const FQuat YawDelta(FVector::UpVector, FMath::DegreesToRadians(YawOffset));
+
+	for (const FSkatePresentationComponent& Presentation : SkatePresentationComponents)
+	{
+		if (USceneComponent* Component = Presentation.Component.Get())
+		{
+			// the board tilts around its own origin
+			const FQuat Tilt = Presentation.bIsBoard ? SkateBoardTilt : FQuat::Identity;
+
+			Component->SetRelativeLocationAndRotation(
+				YawDelta.RotateVector(Presentation.BaseRelativeTransform.GetLocation()) + LocalOffset,
+				YawDelta * Tilt * Presentation.BaseRelativeTransform.GetRotation());
+		}
+	}
+}
+
+void UMauriSkateMovementComponent::MoveSkateAlongFloor(const FVector& Delta, const FQuat& NewRotation, float DeltaSeconds, FStepDownResult* OutStepDownResult)
+{
+	if (!CurrentFloor.IsWalkableFloor())
+	{
+		return;
+	}
+
+	// project the move onto the floor we're standing on
+	const FVector FloorDelta = ComputeGroundMovementDelta(Delta, CurrentFloor.HitResult, CurrentFloor.bLineTrace);
+	FHitResult Hit(1.f);
+	SafeMoveUpdatedComponent(FloorDelta, NewRotation, true, Hit);
+	float LastMoveTimeSlice = DeltaSeconds;
+
+	if (Hit.bStartPenetrating)
+	{
+		// allow this hit to be used as an impact we can deflect off, otherwise we do nothing the rest of the update and appear to hitch
+		HandleImpact(Hit);
+		SlideAlongSurface(FloorDelta, 1.f, Hit.Normal, Hit, true);
+
+		if (Hit.bStartPenetrating)
+		{
+			OnCharacterStuckInGeometry(&Hit);
+		}
+	}
+	else if (Hit.IsValidBlockingHit())
+	{
+		// we impacted something, usually the start of a ramp
+		float PercentTimeApplied = Hit.Time;
+		if ((Hit.Time > 0.f) && (Hit.Normal.Z > UE_KINDA_SMALL_NUMBER) && IsWalkable(Hit))
+		{
+			// another walkable ramp
+			const float InitialPercentRemaining = 1.f - PercentTimeApplied;
+			const FVector RampDelta = ComputeGroundMovementDelta(Delta * InitialPercentRemaining, Hit, false);
+			LastMoveTimeSlice = InitialPercentRemaining * LastMoveTimeSlice;
+			SafeMoveUpdatedComponent(RampDelta, UpdatedComponent->GetComponentQuat(), true, Hit);
+
+			const float SecondHitPercent = Hit.Time * InitialPercentRemaining;
+			PercentTimeApplied = FMath::Clamp(PercentTimeApplied + SecondHitPercent, 0.f, 1.f);
+		}
+
+		if (Hit.IsValidBlockingHit())
+		{
+			if (CanStepUp(Hit) || (CharacterOwner->GetMovementBase() != nullptr && Hit.HitObjectHandle == CharacterOwner->GetMovementBase()->GetOwner()))
+			{
+				// hit a barrier, try to step up
+				const FVector PreStepUpLocation = UpdatedComponent->GetComponentLocation();
+				if (!StepUp(-GetGravityDirection(), Delta * (1.f - PercentTimeApplied), Hit, OutStepDownResult))
+				{
+					HandleImpact(Hit, LastMoveTimeSlice, FloorDelta);
+					SlideAlongSurface(FloorDelta, 1.f - PercentTimeApplied, Hit.Normal, Hit, true);
+				}
+				else if (!bMaintainHorizontalGroundVelocity)
+				{
+					// don't recalculate velocity based on this height adjustment, if considering vertical adjustments
+					bJustTeleported = true;
+					const float StepUpTimeSlice = (1.f - PercentTimeApplied) * DeltaSeconds;
+					if (StepUpTimeSlice >= UE_KINDA_SMALL_NUMBER)
+					{
+						Velocity = (UpdatedComponent->GetComponentLocation() - PreStepUpLocation) / StepUpTimeSlice;
+						Velocity.Z = 0;
+					}
+				}
+			}
+			else if (Hit.Component.IsValid() && !Hit.Component.Get()->CanCharacterStepUp(CharacterOwner))
+			{
+				HandleImpact(Hit, LastMoveTimeSlice, FloorDelta);
+				SlideAlongSurface(FloorDelta, 1.f - PercentTimeApplied, Hit.Normal, Hit, true);
+			}
+		}
+	}
+}
@@ -0,0 +1,453 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/ChaosEngineInterface.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "SkateSimulation.h"
+#include "WorldCollision.h"
+#include "MauriSkateMovementComponent.generated.h"
+
+class AMauriSkateCharacter;
+class UCurveFloat;
+class UFXSystemAsset;
+class USoundBase;
+
+/** Custom movement modes used by the skate, stored in CustomMovementMode while in MOVE_Custom */
+UENUM(BlueprintType)
+enum class ESkateMovementMode : uint8
+{
+	None		UMETA(Hidden),
+	Skating		UMETA(DisplayName = "Skating")
+};
+
+/** How the skate responds to one physical surface */
+USTRUCT()
+struct FSkateSurfaceResponse
+{
+	GENERATED_BODY()
+
+	/** Surface type set on the physical material */
+	UPROPERTY(EditAnywhere, Category="Skate")
+	TEnumAsByte<EPhysicalSurface> Surface = SurfaceType_Default;
+
+	/** Multiplier for both frictions on this surface */
+	UPROPERTY(EditAnywhere, Category="Skate", meta = (ClampMin = 0))
+	float FrictionScale = 1.0f;
+
+	/** Rolling friction multiplier by speed. Flat if unset */
+	UPROPERTY(EditAnywhere, Category="Skate")
+	TObjectPtr<UCurveFloat> RollingFrictionCurve;
+
+	/** Slow down friction multiplier by speed. Flat if unset */
+	UPROPERTY(EditAnywhere, Category="Skate")
+	TObjectPtr<UCurveFloat> SlowDownFrictionCurve;
+
+	/** Multiplier for the skate's max horizontal speed on this surface */
+	UPROPERTY(EditAnywhere, Category="Skate", meta = (ClampMin = 0))
+	float MaxSpeedScale = 1.0f;
+
+	/** Sound of the wheels rolling on this surface */
+	UPROPERTY(EditAnywhere, Category="Skate")
+	TObjectPtr<USoundBase> RollingSound;
+
+	/** Effect spawned by the wheels rolling on this surface */
+	UPROPERTY(EditAnywhere, Category="Skate")
+	TObjectPtr<UFXSystemAsset> RollingEffect;
+};
+
+/** A surface response ready for lookups, with its friction curves baked */
+struct FSkateSurfaceRecord
+{
+	FSkateFrictionTable Friction;
+	float MaxSpeedScale = 1.0f;
+	TObjectPtr<USoundBase> RollingSound;
+	TObjectPtr<UFXSystemAsset> RollingEffect;
+};
+
+/** A change of slope found ahead of the board by the ramp probe */
+struct FSkateUpcomingSlope
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Normal = FVector::UpVector;
+	bool bValid = false;
+};
+
+/**
+ *  Saved move for the skate.
+ *  Carries the push request, slow down state, turn target and upcoming slope so they can be replayed after a correction.
+ */
+class MAURISKATE_API FSavedMove_Skate : public FSavedMove_Character
+{
+public:
+
+	typedef FSavedMove_Character Super;
+
+	/** Push requested on this move */
+	bool bSavedPushRequested = false;
+
+	/** Slow down friction in use on this move */
+	bool bSavedSlowingDown = false;
+
+	/** A turn target was set on this move */
+	bool bSavedHasTurnTarget = false;
+
+	/** Turn target yaw, already quantized to what the network sends */
+	float SavedTurnTargetYaw = 0.0f;
+
+	/** Slope change the ramp gravity was blending towards on this move */
+	FSkateUpcomingSlope SavedUpcomingSlope;
+
+	// ~begin FSavedMove_Character interface
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+	// ~end FSavedMove_Character interface
+};
+
+/**
+ *  Client prediction data for the skate. Allocates skate saved moves
+ */
+class MAURISKATE_API FNetworkPredictionData_Client_Skate : public FNetworkPredictionData_Client_Character
+{
+public:
+
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	/** Constructor */
+	FNetworkPredictionData_Client_Skate(const UCharacterMovementComponent& ClientMovement);
+
+	/** Allocates a skate saved move */
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/**
+ *  Move data sent from the client to the server.
+ *  Adds the turn target yaw, only serialized on moves that actually turn.
+ */
+struct MAURISKATE_API FSkateNetworkMoveData : public FCharacterNetworkMoveData
+{
+	typedef FCharacterNetworkMoveData Super;
+
+	/** Turn target yaw, compressed to a short */
+	uint16 CompressedTurnTargetYaw = 0;
+
+	// ~begin FCharacterNetworkMoveData interface
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+	// ~end FCharacterNetworkMoveData interface
+};
+
+/**
+ *  Storage for the new, pending and old skate move data
+ */
+struct MAURISKATE_API FSkateNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+	/** Constructor */
+	FSkateNetworkMoveDataContainer();
+
+	/** Backing storage for the move data pointers */
+	FSkateNetworkMoveData SkateMoveData[3];
+};
+
+/**
+ *  Move response sent from the server to the client.
+ *  Corrections also carry the skate simulation state, so the client replays from the server's push phase.
+ */
+struct MAURISKATE_API FSkateMoveResponseDataContainer : public FCharacterMoveResponseDataContainer
+{
+	typedef FCharacterMoveResponseDataContainer Super;
+
+	/** Server push time left */
+	float PushRemainingTime = 0.0f;
+
+	/** Server push impulse already applied */
+	bool bPushingInstantReached = false;
+
+	/** Server time waiting to be simulated */
+	float SimAccumulator = 0.0f;
+
+	// ~begin FCharacterMoveResponseDataContainer interface
+	virtual void ServerFillResponseData(const UCharacterMovementComponent& CharacterMovement, const FClientAdjustment& PendingAdjustment) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap) override;
+	// ~end FCharacterMoveResponseDataContainer interface
+};
+
+/**
+ *  Character movement for the skate.
+ *  Ground movement runs in a custom Skating mode that advances the FSkateSimStep core at a fixed rate,
+ *  moving and rotating the board with one sweep per step. Attached meshes are interpolated between steps.
+ *  Falling and the rest of the built-in modes are left to UCharacterMovementComponent.
+ */
+UCLASS()
+class MAURISKATE_API UMauriSkateMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Rate the skate simulation runs at, regardless of the frame rate */
+	UPROPERTY(EditAnywhere, Category="Skate|Simulation", meta = (ClampMin = 10, ClampMax = 480, Units = "Hz"))
+	float SkateSimulationRate = 120.0f;
+
+	/** Max number of skate simulation steps per frame. Time beyond that is dropped after a hitch */
+	UPROPERTY(EditAnywhere, Category="Skate|Simulation", meta = (ClampMin = 1, ClampMax = 32))
+	int32 MaxSkateStepsPerFrame = 8;
+
+	/** If true, an async trace probes the floor ahead of the board so slope changes are blended in before we reach them */
+	UPROPERTY(EditAnywhere, Category="Skate|Ramp Probe")
+	bool bEnableSkateRampProbe = true;
+
+	/** How far ahead of the board to probe, in seconds of travel at the current speed */
+	UPROPERTY(EditAnywhere, Category="Skate|Ramp Probe", meta = (ClampMin = 0, ClampMax = 1, Units = "s", EditCondition = "bEnableSkateRampProbe"))
+	float SkateRampProbeLookAheadTime = 0.1f;
+
+	/** Number of traces spread evenly along the predicted path, up to the look-ahead time */
+	UPROPERTY(EditAnywhere, Category="Skate|Ramp Probe", meta = (ClampMin = 1, ClampMax = 8, EditCondition = "bEnableSkateRampProbe"))
+	int32 SkateRampProbeSamples = 3;
+
+	/** How far below the bottom of the capsule the probe looks for floor */
+	UPROPERTY(EditAnywhere, Category="Skate|Ramp Probe", meta = (ClampMin = 0, Units = "cm", EditCondition = "bEnableSkateRampProbe"))
+	float SkateRampProbeDepth = 100.0f;
+
+	/** Distance to an upcoming slope change at which its floor normal starts blending into the ramp gravity */
+	UPROPERTY(EditAnywhere, Category="Skate|Ramp Probe", meta = (ClampMin = 1, Units = "cm", EditCondition = "bEnableSkateRampProbe"))
+	float SkateRampProbeBlendDistance = 100.0f;
+
+	/** Rolling friction multiplier by speed, for surfaces without their own curves. Flat if unset */
+	UPROPERTY(EditAnywhere, Category="Skate|Friction")
+	TObjectPtr<UCurveFloat> SkateRollingFrictionCurve;
+
+	/** Slow down friction multiplier by speed, for surfaces without their own curves. Flat if unset */
+	UPROPERTY(EditAnywhere, Category="Skate|Friction")
+	TObjectPtr<UCurveFloat> SkateSlowDownFrictionCurve;
+
+	/** Friction, speed, sound and effects for specific physical surfaces. Other surfaces use the default curves */
+	UPROPERTY(EditAnywhere, Category="Skate|Friction")
+	TArray<FSkateSurfaceResponse> SkateSurfaceResponses;
+
+	/** Speed range the friction curves are baked over. Faster speeds use the value at this speed */
+	UPROPERTY(EditAnywhere, Category="Skate|Friction", meta = (ClampMin = 1, Units = "cm/s"))
+	float SkateFrictionCurveMaxSpeed = 1500.0f;
+
+public:
+
+	/** Constructor */
+	UMauriSkateMovementComponent();
+
+	/** Starts a push on the next simulation step, if the skate is free to push */
+	void RequestSkatePush();
+
+	/** Queues an extra push impulse along the board's forward direction. Applied on the next simulation step */
+	void AddSkatePush(float Factor);
+
+	/** Sets the rotation the board will turn towards on the next simulation steps */
+	void SetSkateTurnTarget(const FRotator& TargetRotation);
+
+	/** Queues a turn direction sample. The latest sample this frame becomes the turn target on the next movement update */
+	void AddSkateTurnInput(const FVector& Direction);
+
+	/** Switches between the floor and the slow down friction */
+	void SetSkateSlowingDown(bool bSlowingDown);
+
+	/** Drops every pending input and push, and restarts the simulation from the current transform with the provided velocity */
+	void ResetSkateState(const FVector& InVelocity);
+
+	/** Returns true while a push is playing or about to start */
+	bool IsSkatePushing() const;
+
+	/** Returns true while the component is in the custom Skating mode */
+	UFUNCTION(BlueprintPure, Category="Skate")
+	bool IsSkating() const;
+
+	/** Interpolates the provided component between simulation steps. Must be attached to the capsule. Board components also follow the board tilt */
+	void AddSkatePresentationComponent(USceneComponent* Component, bool bIsBoard = false);
+
+	/** Sets the pitch and roll of the board relative to the capsule, applied on the next presentation update */
+	void SetSkateBoardTilt(const FRotator& Tilt) { SkateBoardTilt = Tilt.Quaternion(); }
+
+	/** Returns the current skate simulation state */
+	const FSkateSimState& GetSkateSimState() const { return SkateSimState; }
+
+	/** Returns the tuning the skate simulation last ran with */
+	const FSkateSimParams& GetSkateSimParams() const { return SkateSimParams; }
+
+	/** Builds the simulation tuning for the provided character with this component's settings. Also usable on class defaults */
+	FSkateSimParams BuildSkateSimParams(const AMauriSkateCharacter& Character, float InGravityZ) const;
+
+	/** Returns the rolling sound of the current floor, as resolved for the last step */
+	UFUNCTION(BlueprintPure, Category="Skate")
+	USoundBase* GetSkateSurfaceRollingSound() const;
+
+	/** Returns the rolling effect of the current floor, as resolved for the last step */
+	UFUNCTION(BlueprintPure, Category="Skate")
+	UFXSystemAsset* GetSkateSurfaceRollingEffect() const;
+
+	/** Returns the fixed step clock of the skate simulation */
+	const FSkateSimAccumulator& GetSkateSimAccumulator() const { return SkateSimAccumulator; }
+
+	/** Returns true if a push was requested and not yet consumed by a step */
+	bool IsSkatePushRequested() const { return bSkatePushRequested; }
+
+	/** Returns true while the slow down friction is in use */
+	bool IsSkateSlowingDown() const { return bIsSkateSlowingDown; }
+
+	/** Returns true if a turn target is waiting for the next step */
+	bool HasSkateTurnTarget() const { return bHasSkateTurnTarget; }
+
+	/** Returns the rotation the board is turning towards */
+	const FRotator& GetSkateTurnTarget() const { return SkateTurnTarget; }
+
+	/** Returns the slope change the ramp gravity is blending towards */
+	const FSkateUpcomingSlope& GetUpcomingSkateSlope() const { return UpcomingSkateSlope; }
+
+	/** Restores the slope change the ramp gravity blends towards, when replaying a saved move */
+	void SetUpcomingSkateSlope(const FSkateUpcomingSlope& Slope) { UpcomingSkateSlope = Slope; }
+
+	// ~begin UCharacterMovementComponent interface
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void SetUpdatedComponent(USceneComponent* NewUpdatedComponent) override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual bool IsMovingOnGround() const override;
+	virtual float GetMaxSpeed() const override;
+	virtual void SetDefaultMovementMode() override;
+	virtual void ComputeFloorDist(const FVector& CapsuleLocation, float LineDistance, float SweepDistance, FFindFloorResult& OutFloorResult, float SweepRadius, const FHitResult* DownwardSweepResult = nullptr) const override;
+	// ~end UCharacterMovementComponent interface
+
+protected:
+
+	// ~begin UCharacterMovementComponent interface
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+	virtual void SetPostLandedPhysics(const FHitResult& Hit) override;
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+	virtual void OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity) override;
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+	virtual bool MoveUpdatedComponentImpl(const FVector& Delta, const FQuat& NewRotation, bool bSweep, FHitResult* OutHit = nullptr, ETeleportType Teleport = ETeleportType::None) override;
+	virtual void OnClientCorrectionReceived(FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode, FVector ServerGravityDirection) override;
+	// ~end UCharacterMovementComponent interface
+
+	/** Ground movement for the skate */
+	void PhysSkating(float deltaTime, int32 Iterations);
+
+	/** Copies the skate tuning from the owning character */
+	FSkateSimParams GatherSkateSimParams() const;
+
+	/** Issues this frame's async floor traces along the path ahead of the board. The results arrive next frame */
+	void IssueSkateRampProbe();
+
+	/** Async trace callback. Keeps the closest slope change found ahead of the board until the next step picks it up */
+	void OnSkateRampProbeDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	/** Latches the slope change found by the probe, forgets the current one once it's behind us. Live steps only, never replays */
+	void UpdateUpcomingSkateSlope();
+
+	/** Returns the distance left to the upcoming slope change along our heading, or a negative value once it's reached, passed or off our path */
+	float GetUpcomingSkateSlopeDistance() const;
+
+	/** Returns the floor normal the ramp gravity should use, pre-blended towards the upcoming slope change by distance only */
+	FVector ResolveSkateFloorNormal() const;
+
+	/** Turns the latest queued turn sample into the turn target */
+	void FlushSkateTurnInput();
+
+	/** Builds the input for the next simulation step, consuming one-shot requests */
+	FSkateSimInput ConsumeSkateSimInput();
+
+	/** Moves and rotates the board along the floor by Delta, covered in DeltaSeconds. Only ramps and step ups cost an extra sweep */
+	void MoveSkateAlongFloor(const FVector& Delta, const FQuat& NewRotation, float DeltaSeconds, FStepDownResult* OutStepDownResult);
+
+	/** Offsets the presentation components to the interpolated simulation state */
+	void ApplySkatePresentation();
+
+	/** Builds the surface records, sampling the friction curves into lookup tables */
+	void BuildSkateSurfaceRecords();
+
+	/** Returns the record for the current floor. The physical material is only looked up when the floor component changes */
+	const FSkateSurfaceRecord* ResolveSkateSurface();
+
+private:
+
+	/** A component interpolated between simulation steps, with its unmodified relative transform */
+	struct FSkatePresentationComponent
+	{
+		TWeakObjectPtr<USceneComponent> Component;
+		FTransform BaseRelativeTransform;
+		bool bIsBoard = false;
+	};
+
+	/** Skate move data sent to the server */
+	FSkateNetworkMoveDataContainer SkateNetworkMoveDataContainer;
+
+	/** Skate move responses sent to the client */
+	FSkateMoveResponseDataContainer SkateMoveResponseDataContainer;
+
+	/** Owning skate character, where the skate tuning parameters live */
+	UPROPERTY(Transient)
+	TObjectPtr<AMauriSkateCharacter> SkateCharacterOwner;
+
+	/** Skate state after the last simulation step */
+	FSkateSimState SkateSimState;
+
+	/** Skate state before the last simulation step, for presentation interpolation */
+	FSkateSimState PreviousSkateSimState;
+
+	/** Tuning the simulation last ran with */
+	FSkateSimParams SkateSimParams;
+
+	/** Turns frame time into fixed steps */
+	FSkateSimAccumulator SkateSimAccumulator;
+
+	/** Components interpolated between steps */
+	TArray<FSkatePresentationComponent> SkatePresentationComponents;
+
+	/** Surface records, dense. The first one is for surfaces without their own response */
+	TArray<FSkateSurfaceRecord> SkateSurfaceRecords;
+
+	/** Record of every physical surface type */
+	uint8 SkateSurfaceRecordIndices[SurfaceType_Max] = {};
+
+	/** Floor component the surface was last looked up for, and its record */
+	TWeakObjectPtr<const UPrimitiveComponent> SkateSurfaceFloor;
+	int32 SkateSurfaceFloorRecord = 0;
+
+	/** Board pitch and roll relative to the capsule */
+	FQuat SkateBoardTilt = FQuat::Identity;
+
+	/** True if a push was requested and not yet consumed by a step */
+	bool bSkatePushRequested = false;
+
+	/** Extra push factor waiting to be applied on the next step */
+	float PendingSkatePush = 0.0f;
+
+	/** Rotation the board is turning towards */
+	FRotator SkateTurnTarget = FRotator::ZeroRotator;
+
+	/** Callback for the ramp probe traces */
+	FTraceDelegate SkateRampProbeDelegate;
+
+	/** Slope change the ramp gravity blends towards. Only changes at the start of a live step */
+	FSkateUpcomingSlope UpcomingSkateSlope;
+
+	/** Closest slope change the probe has returned since the last step */
+	FSkateUpcomingSlope ProbedSkateSlope;
+
+	/** Latest turn direction received since the last movement update */
+	FVector PendingSkateTurnDirection = FVector::ZeroVector;
+
+	/** True if PendingSkateTurnDirection holds a sample not yet turned into a target */
+	bool bHasPendingSkateTurn = false;
+
+	/** True if a turn target was set since the last step */
+	bool bHasSkateTurnTarget = false;
+
+	/** True while the slow down friction is in use */
+	bool bIsSkateSlowingDown = false;
+
+	/** True if at least one simulation step ran during this movement update */
+	bool bSkateStepRanThisUpdate = false;
+};
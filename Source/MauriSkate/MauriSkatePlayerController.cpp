@@ -2,11 +2,13 @@
 
 
 #include "MauriSkatePlayerController.h"
+#include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "Engine/LocalPlayer.h"
 #include "InputMappingContext.h"
 #include "Blueprint/UserWidget.h"
 #include "MauriSkate.h"
+#include "SkateResetSubsystem.h"
 #include "Widgets/Input/SVirtualJoystick.h"
 
 void AMauriSkatePlayerController::BeginPlay()
@@ -57,5 +59,28 @@ void AMauriSkatePlayerController::SetupInputComponent()
 				}
 			}
 		}
+
+		// resetting is handled in place instead of restarting the level
+		UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(InputComponent);
+		if (EnhancedInputComponent && ResetAction)
+		{
+			EnhancedInputComponent->BindAction(ResetAction, ETriggerEvent::Started, this, &AMauriSkatePlayerController::ResetLevel);
+		}
+		else
+		{
+			// the controller's bindings come first and consume the keys, so the skate Blueprint's level reload on the same keys never fires
+			for (const FKey& Key : ResetKeys)
+			{
+				InputComponent->BindKey(Key, IE_Pressed, this, &AMauriSkatePlayerController::ResetLevel);
+			}
+		}
+	}
+}
+
+void AMauriSkatePlayerController::ResetLevel()
+{
+	if (USkateResetSubsystem* Reset = GetWorld()->GetSubsystem<USkateResetSubsystem>())
+	{
+		Reset->ResetWorld();
 	}
 }
@@ -4,8 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "InputCoreTypes.h"
 #include "MauriSkatePlayerController.generated.h"
 
+class UInputAction;
 class UInputMappingContext;
 class UUserWidget;
 
@@ -28,6 +30,14 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Input|Input Mappings")
 	TArray<UInputMappingContext*> MobileExcludedMappingContexts;
 
+	/** Resets the level in place */
+	UPROPERTY(EditAnywhere, Category="Input")
+	UInputAction* ResetAction;
+
+	/** Keys that reset the level in place while no ResetAction is set. They're handled before the pawn's own bindings for the same keys */
+	UPROPERTY(EditAnywhere, Category="Input")
+	TArray<FKey> ResetKeys = { EKeys::Escape, EKeys::K };
+
 	/** Mobile controls widget to spawn */
 	UPROPERTY(EditAnywhere, Category="Input|Touch Controls")
 	TSubclassOf<UUserWidget> MobileControlsWidgetClass;
@@ -41,4 +51,7 @@ protected:
 	/** Input mapping context setup */
 	virtual void SetupInputComponent() override;
 
+	/** Puts the skaters, obstacles and points back to how the level started */
+	void ResetLevel();
+
 };
@@ -5,17 +5,14 @@
 
 #include "GamePointsComponent.h"
 #include "MauriSkateCharacter.h"
+#include "ObstacleWorldSubsystem.h"
 #include "Components/BoxComponent.h"
-#include "GameFramework/GameModeBase.h"
 
 // Sets default values for this component's properties
 UObstacleSettingsComponent::UObstacleSettingsComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
-
-	// ...
+	// The UObstacleWorldSubsystem does the detection, so this component never needs to tick
+	PrimaryComponentTick.bCanEverTick = false;
 }
 
 
@@ -26,52 +23,68 @@ void UObstacleSettingsComponent::BeginPlay()
 	UBoxComponent* Trigger =  GetOwner()->GetComponentByClass<UBoxComponent>();
 	UStaticMeshComponent* Obstacle =  GetOwner()->GetComponentByClass<UStaticMeshComponent>();
 
-	Trigger->OnComponentBeginOverlap.AddDynamic(this,&UObstacleSettingsComponent::TriggerJustEntered);
-	Trigger->OnComponentEndOverlap.AddDynamic(this,&UObstacleSettingsComponent::TriggerJustLeft);
-	Obstacle->OnComponentHit.AddDynamic(this,&UObstacleSettingsComponent::ObstacleJustHit);
+	// The subsystem tests the trigger against the skaters itself, it doesn't need physics overlaps
+	if (Trigger)
+	{
+		Trigger->SetGenerateOverlapEvents(false);
+		Trigger->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	}
+
+	if (UObstacleWorldSubsystem* Obstacles = GetWorld()->GetSubsystem<UObstacleWorldSubsystem>())
+	{
+		Obstacles->RegisterObstacle(this, Trigger, Obstacle);
+	}
+
+	if (USkateResetSubsystem* Reset = GetWorld()->GetSubsystem<USkateResetSubsystem>())
+	{
+		Reset->RegisterResettable(this);
+	}
 }
 
-void UObstacleSettingsComponent::TriggerJustEntered(UPrimitiveComponent* OverlappedComponent,
-	AActor* OtherActor,
-	UPrimitiveComponent* OtherComp,
-	int32 OtherBodyIndex,
-	bool bFromSweep,
-	const FHitResult& SweepResult)
+void UObstacleSettingsComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	if (AMauriSkateCharacter * SkatePawn = Cast<AMauriSkateCharacter>(OtherActor)) {
-		bPawnIsCrossing = true;
+	if (UObstacleWorldSubsystem* Obstacles = GetWorld()->GetSubsystem<UObstacleWorldSubsystem>())
+	{
+		Obstacles->UnregisterObstacle(this);
+	}
+
+	if (USkateResetSubsystem* Reset = GetWorld()->GetSubsystem<USkateResetSubsystem>())
+	{
+		Reset->UnregisterResettable(this);
 	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void UObstacleSettingsComponent::TriggerJustLeft(
-	UPrimitiveComponent* OverlappedComponent,
-	AActor* OtherActor,
-	UPrimitiveComponent* OtherComp,
-	int32 OtherBodyIndex)
+void UObstacleSettingsComponent::HandleSkaterEntered(AMauriSkateCharacter* SkatePawn)
 {
-	if (AMauriSkateCharacter * SkatePawn = Cast<AMauriSkateCharacter>(OtherActor)) {
-		if (bPawnIsCrossing) {
-			bPawnIsCrossing = false;
-			UGamePointsComponent * PointsManager = GetWorld()->GetFirstPlayerController()->GetComponentByClass<UGamePointsComponent>();
-			PointsManager->AwardPoints(PointsToAward);
+	// Forget pawns that were destroyed mid crossing
+	for (auto It = CrossingPawns.CreateIterator(); It; ++It) {
+		if (!It->IsValid()) {
+			It.RemoveCurrent();
 		}
 	}
+
+	CrossingPawns.Add(SkatePawn);
 }
 
-void UObstacleSettingsComponent::ObstacleJustHit(UPrimitiveComponent* HitComponent, AActor* OtherActor,
-	UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+void UObstacleSettingsComponent::HandleSkaterLeft(AMauriSkateCharacter* SkatePawn)
 {
-	if (AMauriSkateCharacter * SkatePawn = Cast<AMauriSkateCharacter>(OtherActor)) {
-		SkatePawn->KillCharacter();
+	if (CrossingPawns.Remove(SkatePawn) > 0) {
+		// Points go to whoever crossed, so bots and other players score on their own
+		if (UGamePointsComponent * PointsManager = UGamePointsComponent::FindForPawn(SkatePawn)) {
+			PointsManager->AwardPoints(PointsToAward);
+		}
 	}
 }
 
-
-// Called every frame
-void UObstacleSettingsComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UObstacleSettingsComponent::HandleSkaterCrashed(AMauriSkateCharacter* SkatePawn)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
-	// ...
+	SkatePawn->KillCharacter();
 }
 
+void UObstacleSettingsComponent::RestoreResetState()
+{
+	// Nobody is halfway over the obstacle when the run starts
+	CrossingPawns.Reset();
+}
@@ -4,11 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "SkateResetSubsystem.h"
 #include "ObstacleSettingsComponent.generated.h"
 
+class AMauriSkateCharacter;
+class APawn;
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
-class MAURISKATE_API UObstacleSettingsComponent : public UActorComponent
+class MAURISKATE_API UObstacleSettingsComponent : public UActorComponent, public ISkateResettable
 {
 	GENERATED_BODY()
 
@@ -20,35 +23,28 @@ public:
 	int PointsToAward = 1;
 
 private:
-	bool bPawnIsCrossing = false;
+	// Pawns currently inside the trigger. Each one scores for itself when it leaves
+	TSet<TWeakObjectPtr<APawn>, DefaultKeyFuncs<TWeakObjectPtr<APawn>>, TInlineSetAllocator<4>> CrossingPawns;
 	
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
-	UFUNCTION()
-	void TriggerJustEntered(UPrimitiveComponent* OverlappedComponent,
-		AActor* OtherActor,
-		UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex,
-		bool bFromSweep,
-		const FHitResult& SweepResult);
-
-	UFUNCTION()
-	void TriggerJustLeft(
-		UPrimitiveComponent* OverlappedComponent,
-		AActor* OtherActor,
-		UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex
-	);
-
-	UFUNCTION()
-	void ObstacleJustHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, 
-			   FVector NormalImpulse, const FHitResult& Hit);
-	
-public:	
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	// Called when the game ends or the obstacle is removed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// Called by the UObstacleWorldSubsystem when a skater's capsule starts overlapping the trigger
+	void HandleSkaterEntered(AMauriSkateCharacter* SkatePawn);
+
+	// Called by the UObstacleWorldSubsystem when a skater's capsule stops overlapping the trigger
+	void HandleSkaterLeft(AMauriSkateCharacter* SkatePawn);
+
+	// Called by the UObstacleWorldSubsystem when a skater runs into the side of the obstacle mesh
+	void HandleSkaterCrashed(AMauriSkateCharacter* SkatePawn);
 
-		
+	// ~begin ISkateResettable interface
+	virtual void CaptureResetState() override {}
+	virtual void RestoreResetState() override;
+	// ~end ISkateResettable interface
 };
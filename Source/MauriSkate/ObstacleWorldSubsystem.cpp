@@ -0,0 +1,335 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ObstacleWorldSubsystem.h"
+#include "MauriSkateCharacter.h"
+#include "ObstacleSettingsComponent.h"
+#include "SkateTelemetry.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+
+DECLARE_CYCLE_STAT(TEXT("Obstacle Queries"), STAT_ObstacleQueries, STATGROUP_Skate);
+
+void UObstacleWorldSubsystem::RegisterObstacle(UObstacleSettingsComponent* Obstacle, const UPrimitiveComponent* Trigger, const UPrimitiveComponent* Barrier)
+{
+	if (!Obstacle || ObstacleIndices.Contains(Obstacle))
+	{
+		return;
+	}
+
+	FObstacleEntry Entry;
+	Entry.Obstacle = Obstacle;
+
+	FBox Bounds(ForceInit);
+
+	if (Trigger)
+	{
+		Entry.Trigger = MakeObstacleBox(Trigger);
+		Entry.bHasTrigger = true;
+		Bounds += Trigger->Bounds.GetBox();
+	}
+
+	if (Barrier)
+	{
+		Entry.Barrier = MakeObstacleBox(Barrier);
+		Entry.bHasBarrier = true;
+		Bounds += Barrier->Bounds.GetBox();
+	}
+
+	if (!Bounds.IsValid)
+	{
+		return;
+	}
+
+	Entry.Cells = GetCellRect(Bounds);
+
+	const int32 Index = Obstacles.Add(MoveTemp(Entry));
+	ObstacleIndices.Add(Obstacle, Index);
+
+	const FIntRect& CellRect = Obstacles[Index].Cells;
+	for (int32 X = CellRect.Min.X; X <= CellRect.Max.X; ++X)
+	{
+		for (int32 Y = CellRect.Min.Y; Y <= CellRect.Max.Y; ++Y)
+		{
+			Cells.FindOrAdd(FIntPoint(X, Y)).Add(Index);
+		}
+	}
+}
+
+void UObstacleWorldSubsystem::UnregisterObstacle(UObstacleSettingsComponent* Obstacle)
+{
+	int32 Index;
+	if (!ObstacleIndices.RemoveAndCopyValue(Obstacle, Index))
+	{
+		return;
+	}
+
+	const FIntRect CellRect = Obstacles[Index].Cells;
+	for (int32 X = CellRect.Min.X; X <= CellRect.Max.X; ++X)
+	{
+		for (int32 Y = CellRect.Min.Y; Y <= CellRect.Max.Y; ++Y)
+		{
+			if (TArray<int32, TInlineAllocator<4>>* Cell = Cells.Find(FIntPoint(X, Y)))
+			{
+				Cell->RemoveSingleSwap(Index);
+				if (Cell->IsEmpty())
+				{
+					Cells.Remove(FIntPoint(X, Y));
+				}
+			}
+		}
+	}
+
+	// the index may get reused, so skaters can't keep referring to it
+	for (FSkaterEntry& Skater : Skaters)
+	{
+		Skater.OverlappingTriggers.RemoveSingleSwap(Index);
+		Skater.TouchingBarriers.RemoveSingleSwap(Index);
+	}
+
+	Obstacles.RemoveAt(Index);
+}
+
+void UObstacleWorldSubsystem::RegisterSkater(AMauriSkateCharacter* Skater)
+{
+	if (!Skater || Skaters.ContainsByPredicate([Skater](const FSkaterEntry& Entry) { return Entry.Skater == Skater; }))
+	{
+		return;
+	}
+
+	FSkaterEntry& Entry = Skaters.AddDefaulted_GetRef();
+	Entry.Skater = Skater;
+	Entry.PreviousLocation = Skater->GetActorLocation();
+}
+
+void UObstacleWorldSubsystem::UnregisterSkater(AMauriSkateCharacter* Skater)
+{
+	Skaters.RemoveAllSwap([Skater](const FSkaterEntry& Entry) { return Entry.Skater == Skater; });
+}
+
+void UObstacleWorldSubsystem::ResetSkater(AMauriSkateCharacter* Skater)
+{
+	for (FSkaterEntry& Entry : Skaters)
+	{
+		if (Entry.Skater == Skater)
+		{
+			Entry.PreviousLocation = Skater->GetActorLocation();
+			Entry.OverlappingTriggers.Reset();
+			Entry.TouchingBarriers.Reset();
+		}
+	}
+}
+
+void UObstacleWorldSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ObstacleQueries);
+
+	// forget skaters that went away without unregistering
+	Skaters.RemoveAllSwap([](const FSkaterEntry& Entry) { return !Entry.Skater.IsValid(); });
+
+	PendingEvents.Reset();
+
+	for (FSkaterEntry& Entry : Skaters)
+	{
+		UpdateSkater(Entry, PendingEvents);
+	}
+
+	// respond once the whole batch is known, so gameplay reactions can't disturb the queries
+	for (const FObstacleEvent& Event : PendingEvents)
+	{
+		AMauriSkateCharacter* Skater = Event.Skater.Get();
+		UObstacleSettingsComponent* Obstacle = Obstacles.IsValidIndex(Event.ObstacleIndex) ? Obstacles[Event.ObstacleIndex].Obstacle.Get() : nullptr;
+		if (!Skater || !Obstacle)
+		{
+			continue;
+		}
+
+		switch (Event.Type)
+		{
+		case EObstacleEventType::Entered:
+			Obstacle->HandleSkaterEntered(Skater);
+			break;
+
+		case EObstacleEventType::Left:
+			Obstacle->HandleSkaterLeft(Skater);
+			break;
+
+		case EObstacleEventType::Crashed:
+			Obstacle->HandleSkaterCrashed(Skater);
+			break;
+		}
+	}
+}
+
+void UObstacleWorldSubsystem::UpdateSkater(FSkaterEntry& Entry, TArray<FObstacleEvent>& OutEvents)
+{
+	const AMauriSkateCharacter* Skater = Entry.Skater.Get();
+	const UCapsuleComponent* Capsule = Skater->GetCapsuleComponent();
+
+	const FVector Start = Entry.PreviousLocation;
+	const FVector End = Skater->GetActorLocation();
+	Entry.PreviousLocation = End;
+
+	const float Radius = Capsule->GetScaledCapsuleRadius();
+	const float HalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+	const FVector CapsuleInflate(Radius, Radius, HalfHeight);
+	const FVector ContactInflate = CapsuleInflate + FVector(ContactTolerance);
+
+	// triggers and barriers touched this frame
+	TArray<int32, TInlineAllocator<4>> Triggers;
+	TArray<int32, TInlineAllocator<2>> Barriers;
+
+	const FBox SweptBounds = FBox(Start.ComponentMin(End), Start.ComponentMax(End)).ExpandBy(ContactInflate);
+	const FIntRect CellRect = GetCellRect(SweptBounds);
+	++QueryStamp;
+
+	for (int32 X = CellRect.Min.X; X <= CellRect.Max.X; ++X)
+	{
+		for (int32 Y = CellRect.Min.Y; Y <= CellRect.Max.Y; ++Y)
+		{
+			const TArray<int32, TInlineAllocator<4>>* Cell = Cells.Find(FIntPoint(X, Y));
+			if (!Cell)
+			{
+				continue;
+			}
+
+			for (const int32 Index : *Cell)
+			{
+				FObstacleEntry& Obstacle = Obstacles[Index];
+				if (Obstacle.QueryStamp == QueryStamp)
+				{
+					continue;
+				}
+				Obstacle.QueryStamp = QueryStamp;
+
+				// anywhere along the move counts, so fast skaters can't skip through a trigger in one frame
+				if (Obstacle.bHasTrigger && SegmentTouchesBox(Obstacle.Trigger, Start, End, CapsuleInflate))
+				{
+					Triggers.Add(Index);
+				}
+
+				// movement stops us against the barrier, so only the end of the move can touch it
+				if (Obstacle.bHasBarrier && CapsuleTouchesBox(Obstacle.Barrier, End, Radius + ContactTolerance, HalfHeight + ContactTolerance))
+				{
+					// landing on top is fine, only the sides of the barrier are a crash
+					const FVector LocalEnd = Obstacle.Barrier.Rotation.UnrotateVector(End - Obstacle.Barrier.Center);
+					const bool bOnTop = LocalEnd.Z - HalfHeight >= Obstacle.Barrier.Extent.Z - ContactTolerance;
+
+					if (!bOnTop)
+					{
+						Barriers.Add(Index);
+					}
+				}
+			}
+		}
+	}
+
+	// entering, either this frame or last frame and still inside
+	for (const int32 Index : Triggers)
+	{
+		if (!Entry.OverlappingTriggers.Contains(Index))
+		{
+			Entry.OverlappingTriggers.Add(Index);
+			OutEvents.Add({ EObstacleEventType::Entered, Index, Entry.Skater });
+		}
+	}
+
+	// leaving. A swept pass right through the trigger enters and leaves on the same frame
+	for (int32 Slot = Entry.OverlappingTriggers.Num() - 1; Slot >= 0; --Slot)
+	{
+		const int32 Index = Entry.OverlappingTriggers[Slot];
+		if (!SegmentTouchesBox(Obstacles[Index].Trigger, End, End, CapsuleInflate))
+		{
+			Entry.OverlappingTriggers.RemoveAtSwap(Slot);
+			OutEvents.Add({ EObstacleEventType::Left, Index, Entry.Skater });
+		}
+	}
+
+	// crashes only fire when contact starts
+	for (const int32 Index : Barriers)
+	{
+		if (!Entry.TouchingBarriers.Contains(Index))
+		{
+			OutEvents.Add({ EObstacleEventType::Crashed, Index, Entry.Skater });
+		}
+	}
+
+	Entry.TouchingBarriers = Barriers;
+}
+
+FIntRect UObstacleWorldSubsystem::GetCellRect(const FBox& Bounds)
+{
+	return FIntRect(
+		FMath::FloorToInt32(Bounds.Min.X / CellSize), FMath::FloorToInt32(Bounds.Min.Y / CellSize),
+		FMath::FloorToInt32(Bounds.Max.X / CellSize), FMath::FloorToInt32(Bounds.Max.Y / CellSize));
+}
+
+UObstacleWorldSubsystem::FObstacleBox UObstacleWorldSubsystem::MakeObstacleBox(const UPrimitiveComponent* Component)
+{
+	const FTransform& Transform = Component->GetComponentTransform();
+
+	// the collision, not the render mesh, is what the skater runs into
+	FBox LocalBox(ForceInit);
+	if (const UBodySetup* BodySetup = Component->GetBodySetup())
+	{
+		LocalBox = BodySetup->AggGeom.CalcAABB(FTransform::Identity);
+	}
+
+	if (!LocalBox.IsValid)
+	{
+		LocalBox = Component->CalcLocalBounds().GetBox();
+	}
+
+	FObstacleBox Box;
+	Box.Center = Transform.TransformPosition(LocalBox.GetCenter());
+	Box.Rotation = Transform.GetRotation();
+	Box.Extent = LocalBox.GetExtent() * Transform.GetScale3D().GetAbs();
+
+	return Box;
+}
+
+bool UObstacleWorldSubsystem::CapsuleTouchesBox(const FObstacleBox& Box, const FVector& Center, float Radius, float HalfHeight)
+{
+	const FVector LocalCenter = Box.Rotation.UnrotateVector(Center - Box.Center);
+
+	// the capsule's sides are round, so measure to the box itself rather than to a box grown by the radius
+	const FVector2D Closest(
+		FMath::Clamp(LocalCenter.X, -Box.Extent.X, Box.Extent.X),
+		FMath::Clamp(LocalCenter.Y, -Box.Extent.Y, Box.Extent.Y));
+
+	if (FVector2D::DistSquared(Closest, FVector2D(LocalCenter)) > FMath::Square(Radius))
+	{
+		return false;
+	}
+
+	return FMath::Abs(LocalCenter.Z) <= Box.Extent.Z + HalfHeight;
+}
+
+bool UObstacleWorldSubsystem::SegmentTouchesBox(const FObstacleBox& Box, const FVector& Start, const FVector& End, const FVector& Inflate)
+{
+	// grow the box by the capsule and test the capsule's center line against it
+	const FVector Extent = Box.Extent + Inflate;
+	const FBox LocalBox(-Extent, Extent);
+
+	const FVector LocalStart = Box.Rotation.UnrotateVector(Start - Box.Center);
+	const FVector LocalEnd = Box.Rotation.UnrotateVector(End - Box.Center);
+
+	if (LocalBox.IsInside(LocalStart) || LocalBox.IsInside(LocalEnd))
+	{
+		return true;
+	}
+
+	const FVector Direction = LocalEnd - LocalStart;
+	return !Direction.IsNearlyZero() && FMath::LineBoxIntersection(LocalBox, LocalStart, LocalEnd, Direction);
+}
+
+TStatId UObstacleWorldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UObstacleWorldSubsystem, STATGROUP_Tickables);
+}
+
+bool UObstacleWorldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ObstacleWorldSubsystem.generated.h"
+
+class AMauriSkateCharacter;
+class UObstacleSettingsComponent;
+class UPrimitiveComponent;
+
+/**
+ *  Detects skaters clearing and crashing into obstacles for the whole level.
+ *  Obstacles register their trigger and barrier boxes in a uniform grid. Once per frame, after movement,
+ *  each skater's swept capsule is tested only against the obstacles in the cells it went through.
+ *  Triggers don't need to generate overlaps and obstacles don't need to bind any delegates.
+ *  Obstacles are expected not to move once registered.
+ */
+UCLASS()
+class MAURISKATE_API UObstacleWorldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Size of a grid cell. Roughly the size of a few obstacles */
+	static constexpr float CellSize = 1000.0f;
+
+	/** Extra distance the barrier test reaches past the capsule, since movement stops the capsule right before touching it */
+	static constexpr float ContactTolerance = 2.0f;
+
+	/** Adds an obstacle. The trigger awards points when crossed, the barrier kills on side contact */
+	void RegisterObstacle(UObstacleSettingsComponent* Obstacle, const UPrimitiveComponent* Trigger, const UPrimitiveComponent* Barrier);
+
+	/** Removes an obstacle */
+	void UnregisterObstacle(UObstacleSettingsComponent* Obstacle);
+
+	/** Starts testing a skater against the obstacles */
+	void RegisterSkater(AMauriSkateCharacter* Skater);
+
+	/** Stops testing a skater */
+	void UnregisterSkater(AMauriSkateCharacter* Skater);
+
+	/** Forgets what a teleported skater was touching, so the jump isn't tested as a move */
+	void ResetSkater(AMauriSkateCharacter* Skater);
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	// ~begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// ~end UWorldSubsystem interface
+
+private:
+
+	/** An oriented box in world space */
+	struct FObstacleBox
+	{
+		FVector Center = FVector::ZeroVector;
+		FQuat Rotation = FQuat::Identity;
+		FVector Extent = FVector::ZeroVector;
+	};
+
+	/** A registered obstacle */
+	struct FObstacleEntry
+	{
+		TWeakObjectPtr<UObstacleSettingsComponent> Obstacle;
+		FObstacleBox Trigger;
+		FObstacleBox Barrier;
+		bool bHasTrigger = false;
+		bool bHasBarrier = false;
+		FIntRect Cells;
+		uint32 QueryStamp = 0;
+	};
+
+	/** A registered skater and what it was touching last frame */
+	struct FSkaterEntry
+	{
+		TWeakObjectPtr<AMauriSkateCharacter> Skater;
+		FVector PreviousLocation = FVector::ZeroVector;
+		TArray<int32, TInlineAllocator<4>> OverlappingTriggers;
+		TArray<int32, TInlineAllocator<2>> TouchingBarriers;
+	};
+
+	/** Obstacle events found this frame, dispatched once the batch is done */
+	enum class EObstacleEventType : uint8
+	{
+		Entered,
+		Left,
+		Crashed
+	};
+
+	struct FObstacleEvent
+	{
+		EObstacleEventType Type;
+		int32 ObstacleIndex;
+		TWeakObjectPtr<AMauriSkateCharacter> Skater;
+	};
+
+	/** Tests one skater, appending its events */
+	void UpdateSkater(FSkaterEntry& Entry, TArray<FObstacleEvent>& OutEvents);
+
+	/** Returns the grid cells a world box covers. Max is inclusive */
+	static FIntRect GetCellRect(const FBox& Bounds);
+
+	/** Builds an oriented box from a component's collision, or its local bounds if it has none */
+	static FObstacleBox MakeObstacleBox(const UPrimitiveComponent* Component);
+
+	/** Returns true if an upright capsule, taken as a cylinder, touches the box. Its corners stay round, unlike a grown box */
+	static bool CapsuleTouchesBox(const FObstacleBox& Box, const FVector& Center, float Radius, float HalfHeight);
+
+	/** Returns true if the segment gets within Inflate of the box */
+	static bool SegmentTouchesBox(const FObstacleBox& Box, const FVector& Start, const FVector& End, const FVector& Inflate);
+
+	/** Registered obstacles. Indices are stable */
+	TSparseArray<FObstacleEntry> Obstacles;
+
+	/** Obstacle index lookup */
+	TMap<TWeakObjectPtr<UObstacleSettingsComponent>, int32> ObstacleIndices;
+
+	/** Obstacles overlapping each grid cell */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Cells;
+
+	/** Registered skaters */
+	TArray<FSkaterEntry> Skaters;
+
+	/** Reused event buffer */
+	TArray<FObstacleEvent> PendingEvents;
+
+	/** Bumped on every query so each obstacle is tested once even if it spans several cells */
+	uint32 QueryStamp = 0;
+};
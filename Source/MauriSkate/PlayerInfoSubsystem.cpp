@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PlayerInfoSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+const TArray<FPlayerInfo>& UPlayerInfoSubsystem::GetPlayers()
+{
+	EnsurePlayers();
+	return Players;
+}
+
+const FPlayerInfo* UPlayerInfoSubsystem::GetPlayer(int32 PlayerIndex)
+{
+	EnsurePlayers();
+
+	// the pawn may have gone away since the cache was filled
+	return Players.FindByPredicate([PlayerIndex](const FPlayerInfo& Player) { return Player.PlayerIndex == PlayerIndex && Player.Pawn.IsValid(); });
+}
+
+APawn* UPlayerInfoSubsystem::GetPlayerPawn(int32 PlayerIndex)
+{
+	const FPlayerInfo* Player = GetPlayer(PlayerIndex);
+	return Player ? Player->Pawn.Get() : nullptr;
+}
+
+bool UPlayerInfoSubsystem::GetDistancesSquared(TConstArrayView<FVector> Locations, TArrayView<float> OutDistancesSquared, int32 PlayerIndex)
+{
+	check(Locations.Num() == OutDistancesSquared.Num());
+
+	const FPlayerInfo* Player = GetPlayer(PlayerIndex);
+	if (!Player)
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < Locations.Num(); ++Index)
+	{
+		OutDistancesSquared[Index] = FVector::DistSquared(Locations[Index], Player->Location);
+	}
+
+	return true;
+}
+
+void UPlayerInfoSubsystem::Tick(float DeltaTime)
+{
+	// tickables run after every actor tick group, so this is the same point of the frame, after the players have moved
+	RefreshPlayers();
+}
+
+void UPlayerInfoSubsystem::EnsurePlayers()
+{
+	if (!bHasPlayers)
+	{
+		RefreshPlayers();
+	}
+}
+
+void UPlayerInfoSubsystem::RefreshPlayers()
+{
+	bHasPlayers = true;
+	Players.Reset();
+
+	// same order as UGameplayStatics::GetPlayerPawn, so player indices match
+	int32 PlayerIndex = 0;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It, ++PlayerIndex)
+	{
+		const APlayerController* Controller = It->Get();
+		APawn* Pawn = Controller ? Controller->GetPawn() : nullptr;
+
+		if (!Pawn)
+		{
+			continue;
+		}
+
+		FPlayerInfo& Player = Players.AddDefaulted_GetRef();
+		Player.PlayerIndex = PlayerIndex;
+		Player.Pawn = Pawn;
+		Player.Location = Pawn->GetActorLocation();
+		Player.Velocity = Pawn->GetVelocity();
+	}
+}
+
+TStatId UPlayerInfoSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPlayerInfoSubsystem, STATGROUP_Tickables);
+}
+
+bool UPlayerInfoSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PlayerInfoSubsystem.generated.h"
+
+/** Where a player's pawn is and how it's moving, as of the end of the last frame */
+struct FPlayerInfo
+{
+	/** Index of the player, as used by UGameplayStatics::GetPlayerPawn */
+	int32 PlayerIndex = 0;
+
+	TWeakObjectPtr<APawn> Pawn;
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+};
+
+/**
+ *  Works out the players' pawns, locations and velocities once per frame, for AI that needs them many times over.
+ *  StateTree tasks and EQS contexts read from here instead of each looking the player up again.
+ *  The cache is filled after all actors have ticked, so every reader on a frame sees the same snapshot:
+ *  where the players ended the last frame. That's where they still are for anything ticking before their movement,
+ *  and one move behind for anything ticking after it.
+ */
+UCLASS()
+class MAURISKATE_API UPlayerInfoSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the cached info for every player with a pawn */
+	const TArray<FPlayerInfo>& GetPlayers();
+
+	/** Returns the cached info for a player, or nullptr if it has no pawn */
+	const FPlayerInfo* GetPlayer(int32 PlayerIndex = 0);
+
+	/** Returns a player's pawn, or nullptr if it has none */
+	APawn* GetPlayerPawn(int32 PlayerIndex = 0);
+
+	/**
+	 *  Fills OutDistancesSquared with the squared distance from each location to a player.
+	 *  Returns false, leaving the output untouched, if the player has no pawn.
+	 */
+	bool GetDistancesSquared(TConstArrayView<FVector> Locations, TArrayView<float> OutDistancesSquared, int32 PlayerIndex = 0);
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	// ~begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// ~end UWorldSubsystem interface
+
+private:
+
+	/** Fills the cache if it was never filled, for reads before the first tick */
+	void EnsurePlayers();
+
+	/** Fills the cache from the players' current pawns */
+	void RefreshPlayers();
+
+	/** Players with a pawn, in player index order */
+	TArray<FPlayerInfo> Players;
+
+	/** True once the cache has been filled */
+	bool bHasPlayers = false;
+};
@@ -0,0 +1,225 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SkateBenchmarkCommandlet.h"
+#include "MauriSkate.h"
+#include "MauriSkateCharacter.h"
+#include "MauriSkateMovementComponent.h"
+#include "SkateTelemetry.h"
+#include "AIController.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerStart.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+USkateBenchmarkCommandlet::USkateBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 USkateBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString MapName = TEXT("/Game/ThirdPerson/Lvl_ThirdPerson");
+	FString SkaterClassPath = TEXT("/Game/ThirdPerson/Blueprints/BP_SkateCharacter.BP_SkateCharacter_C");
+	FString CsvPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"), TEXT("SkateBenchmark.csv"));
+	int32 NumSkaters = 32;
+	int32 NumFrames = 1200;
+	int32 WarmupFrames = 60;
+	float FramesPerSecond = 60.0f;
+
+	FParse::Value(*Params, TEXT("map="), MapName);
+	FParse::Value(*Params, TEXT("skater="), SkaterClassPath);
+	FParse::Value(*Params, TEXT("csv="), CsvPath);
+	FParse::Value(*Params, TEXT("skaters="), NumSkaters);
+	FParse::Value(*Params, TEXT("frames="), NumFrames);
+	FParse::Value(*Params, TEXT("warmup="), WarmupFrames);
+	FParse::Value(*Params, TEXT("fps="), FramesPerSecond);
+
+	const TSubclassOf<AMauriSkateCharacter> SkaterClass = LoadClass<AMauriSkateCharacter>(nullptr, *SkaterClassPath);
+	if (!SkaterClass)
+	{
+		UE_LOG(LogMauriSkate, Error, TEXT("SkateBenchmark: %s is not a skate character class"), *SkaterClassPath);
+		return 1;
+	}
+
+	UWorld* World = StartWorld(MapName);
+	if (!World)
+	{
+		UE_LOG(LogMauriSkate, Error, TEXT("SkateBenchmark: couldn't load %s"), *MapName);
+		return 1;
+	}
+
+	TArray<AMauriSkateCharacter*> Skaters;
+	SpawnSkaters(World, SkaterClass, NumSkaters, Skaters);
+
+	const float DeltaTime = 1.0f / FMath::Max(FramesPerSecond, 1.0f);
+
+	FString Csv = TEXT("Frame,GameThreadMs,MovementMs,MoveSweeps,FloorQueries\n");
+	double TotalGameThreadMs = 0.0;
+	double MaxGameThreadMs = 0.0;
+	double TotalMovementMs = 0.0;
+	int64 TotalSweeps = 0;
+
+	for (int32 Frame = -WarmupFrames; Frame < NumFrames; ++Frame)
+	{
+		DriveSkaters(Skaters, Frame + WarmupFrames, DeltaTime);
+
+		FSkateMovementCounters::Reset();
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		World->Tick(LEVELTICK_All, DeltaTime);
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		++GFrameCounter;
+
+		const double GameThreadMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+		const double MovementMs = FPlatformTime::ToMilliseconds64(FSkateMovementCounters::MovementCycles);
+
+		// warmup frames settle the level and fill the caches, they're not recorded
+		if (Frame < 0)
+		{
+			continue;
+		}
+
+		Csv += FString::Printf(TEXT("%d,%.4f,%.4f,%d,%d\n"), Frame, GameThreadMs, MovementMs, FSkateMovementCounters::MoveSweeps, FSkateMovementCounters::FloorQueries);
+
+		TotalGameThreadMs += GameThreadMs;
+		MaxGameThreadMs = FMath::Max(MaxGameThreadMs, GameThreadMs);
+		TotalMovementMs += MovementMs;
+		TotalSweeps += FSkateMovementCounters::MoveSweeps + FSkateMovementCounters::FloorQueries;
+	}
+
+	StopWorld(World);
+
+	if (!FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogMauriSkate, Error, TEXT("SkateBenchmark: couldn't write %s"), *CsvPath);
+		return 1;
+	}
+
+	const int32 RecordedFrames = FMath::Max(NumFrames, 1);
+	UE_LOG(LogMauriSkate, Display, TEXT("SkateBenchmark: %d skaters, %d frames. Game thread avg %.3f ms, max %.3f ms. Movement avg %.3f ms. %.1f sweeps per frame. Written to %s"),
+		Skaters.Num(), NumFrames, TotalGameThreadMs / RecordedFrames, MaxGameThreadMs, TotalMovementMs / RecordedFrames, static_cast<double>(TotalSweeps) / RecordedFrames, *CsvPath);
+
+	return 0;
+}
+
+UWorld* USkateBenchmarkCommandlet::StartWorld(const FString& MapName) const
+{
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Game;
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(true)
+			.RequiresHitProxies(false)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(true)
+			.SetTransactional(false));
+	}
+
+	World->UpdateWorldComponents(true, false);
+
+	FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+
+	return World;
+}
+
+void USkateBenchmarkCommandlet::StopWorld(UWorld* World) const
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+}
+
+void USkateBenchmarkCommandlet::SpawnSkaters(UWorld* World, TSubclassOf<AMauriSkateCharacter> SkaterClass, int32 NumSkaters, TArray<AMauriSkateCharacter*>& OutSkaters) const
+{
+	FTransform Origin = FTransform::Identity;
+	if (TActorIterator<APlayerStart> It(World); It)
+	{
+		Origin = It->GetActorTransform();
+	}
+
+	// lay the skaters out on a grid so they start apart
+	const int32 Columns = FMath::Max(1, FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(NumSkaters))));
+	const float Spacing = 200.0f;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 Index = 0; Index < NumSkaters; ++Index)
+	{
+		const FVector Offset((Index / Columns) * Spacing, (Index % Columns - Columns / 2) * Spacing, 0.0f);
+		const FTransform SpawnTransform(Origin.GetRotation(), Origin.TransformPosition(Offset));
+
+		AMauriSkateCharacter* Skater = World->SpawnActor<AMauriSkateCharacter>(SkaterClass, SpawnTransform, SpawnParams);
+		if (!Skater)
+		{
+			continue;
+		}
+
+		// the skate only processes input with a controller
+		Skater->AIControllerClass = AAIController::StaticClass();
+		Skater->SpawnDefaultController();
+
+		OutSkaters.Add(Skater);
+	}
+}
+
+void USkateBenchmarkCommandlet::DriveSkaters(const TArray<AMauriSkateCharacter*>& Skaters, int32 Frame, float DeltaTime) const
+{
+	for (int32 Index = 0; Index < Skaters.Num(); ++Index)
+	{
+		AMauriSkateCharacter* Skater = Skaters[Index];
+		if (!IsValid(Skater))
+		{
+			continue;
+		}
+
+		// every skater runs the same script, offset in time so they don't act in lockstep
+		const float Time = (Frame + Index * 17) * DeltaTime;
+		const int32 PhaseFrame = Frame + Index * 17;
+		const int32 FramesPerSecond = FMath::RoundToInt32(1.0f / DeltaTime);
+
+		// push every 3 seconds, same rules as the push input
+		if (PhaseFrame % (FramesPerSecond * 3) == 0 && !Skater->IsPushingNow() && !Skater->IsJumpingNow())
+		{
+			Skater->GetSkateMovement()->RequestSkatePush();
+		}
+
+		// jump every 5 seconds, releasing after a quarter second
+		const int32 JumpFrame = PhaseFrame % (FramesPerSecond * 5);
+		if (JumpFrame == FramesPerSecond * 4)
+		{
+			Skater->DoJumpStart();
+		}
+		else if (JumpFrame == FramesPerSecond * 4 + FramesPerSecond / 4)
+		{
+			Skater->DoJumpEnd();
+		}
+
+		// carve left and right
+		Skater->DoTurn(FMath::Sin(Time * 0.8f), 1.0f);
+	}
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SkateBenchmarkCommandlet.generated.h"
+
+class AMauriSkateCharacter;
+
+/**
+ *  Headless skate performance benchmark.
+ *  Loads the skate level, spawns skaters driven by scripted push, turn and jump input, ticks the world
+ *  a fixed number of frames at a fixed delta and writes the per frame cost to a CSV file.
+ *
+ *  UnrealEditor-Cmd MauriSkate.uproject -run=SkateBenchmark -nullrhi -unattended
+ *      [-map=/Game/ThirdPerson/Lvl_ThirdPerson] [-skater=/Game/ThirdPerson/Blueprints/BP_SkateCharacter.BP_SkateCharacter_C]
+ *      [-skaters=32] [-frames=1200] [-fps=60] [-warmup=60] [-csv=<path>]
+ */
+UCLASS()
+class MAURISKATE_API USkateBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	USkateBenchmarkCommandlet();
+
+	// ~begin UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// ~end UCommandlet interface
+
+protected:
+
+	/** Loads the level and starts play on it. Returns nullptr on failure */
+	UWorld* StartWorld(const FString& MapName) const;
+
+	/** Tears down a world started by StartWorld */
+	void StopWorld(UWorld* World) const;
+
+	/** Spawns the skaters around the player start, each with an AI controller so their input is processed */
+	void SpawnSkaters(UWorld* World, TSubclassOf<AMauriSkateCharacter> SkaterClass, int32 NumSkaters, TArray<AMauriSkateCharacter*>& OutSkaters) const;
+
+	/** Feeds the scripted input for the provided frame. Every skater runs the same script with its own phase */
+	void DriveSkaters(const TArray<AMauriSkateCharacter*>& Skaters, int32 Frame, float DeltaTime) const;
+};
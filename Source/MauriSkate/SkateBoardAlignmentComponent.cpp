@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SkateBoardAlignmentComponent.h"
+#include "MauriSkateCharacter.h"
+#include "MauriSkateMovementComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+
+namespace SkateBoardAlignment
+{
+	/** Wheel traces carry the batch in the high bits of their user data and the wheel in the low ones */
+	constexpr uint32 WheelBits = 2;
+	constexpr uint32 WheelMask = (1u << WheelBits) - 1;
+
+	/** Moves Value towards Target as a critically damped spring that settles in about SmoothingTime */
+	void CriticallyDampedSpring(float& Value, float& Rate, float Target, float SmoothingTime, float DeltaTime)
+	{
+		const float Omega = 2.0f / SmoothingTime;
+		const float X = Omega * DeltaTime;
+		const float Decay = 1.0f / (1.0f + X + 0.48f * X * X + 0.235f * X * X * X);
+
+		const float Change = Value - Target;
+		const float Temp = (Rate + Omega * Change) * DeltaTime;
+
+		Rate = (Rate - Omega * Temp) * Decay;
+		Value = Target + (Change + Temp) * Decay;
+	}
+}
+
+USkateBoardAlignmentComponent::USkateBoardAlignmentComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+
+	WheelTraceDelegate.BindUObject(this, &USkateBoardAlignmentComponent::OnWheelTraceDone);
+}
+
+void USkateBoardAlignmentComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SkateCharacter = Cast<AMauriSkateCharacter>(GetOwner());
+
+	// the tilt has to be ready before the movement update presents the board
+	if (SkateCharacter)
+	{
+		SkateCharacter->GetSkateMovement()->PrimaryComponentTick.AddPrerequisite(this, PrimaryComponentTick);
+	}
+}
+
+void USkateBoardAlignmentComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!SkateCharacter)
+	{
+		return;
+	}
+
+	UMauriSkateMovementComponent* Movement = SkateCharacter->GetSkateMovement();
+
+	// in the air or crashed, the board goes back to flat
+	FRotator TargetTilt = FRotator::ZeroRotator;
+	const bool bOnFloor = Movement->IsMovingOnGround() && !SkateCharacter->IsRagdoll();
+
+	if (bOnFloor && !FitBoardTilt(TargetTilt))
+	{
+		TargetTilt = FRotator(BoardPitch, 0.0f, BoardRoll);
+	}
+
+	SkateBoardAlignment::CriticallyDampedSpring(BoardPitch, BoardPitchRate, TargetTilt.Pitch, SmoothingTime, DeltaTime);
+	SkateBoardAlignment::CriticallyDampedSpring(BoardRoll, BoardRollRate, TargetTilt.Roll, SmoothingTime, DeltaTime);
+
+	Movement->SetSkateBoardTilt(GetBoardTilt());
+
+	if (bOnFloor)
+	{
+		IssueWheelTraces(DeltaTime);
+	}
+	else
+	{
+		// contacts from before the jump are stale by the time we land
+		++IssuedBatch;
+	}
+}
+
+bool USkateBoardAlignmentComponent::FitBoardTilt(FRotator& OutTilt) const
+{
+	// results from an older batch would tilt us to where we were
+	if (ContactBatch != IssuedBatch)
+	{
+		return false;
+	}
+
+	FVector Points[NumWheels];
+	int32 NumPoints = 0;
+
+	for (const FWheelContact& Contact : WheelContacts)
+	{
+		if (Contact.bHit)
+		{
+			Points[NumPoints++] = Contact.Point;
+		}
+	}
+
+	FVector Normal;
+	if (NumPoints == NumWheels)
+	{
+		// the diagonals of the four wheels span the best fitting plane
+		Normal = FVector::CrossProduct(WheelContacts[0].Point - WheelContacts[3].Point, WheelContacts[1].Point - WheelContacts[2].Point);
+	}
+	else if (NumPoints == 3)
+	{
+		Normal = FVector::CrossProduct(Points[1] - Points[0], Points[2] - Points[0]);
+	}
+	else
+	{
+		return false;
+	}
+
+	if (!Normal.Normalize())
+	{
+		return false;
+	}
+
+	if (Normal.Z < 0.0f)
+	{
+		Normal = -Normal;
+	}
+
+	// pitch and roll of the floor, relative to the capsule's facing
+	const FVector LocalNormal = SkateCharacter->GetActorQuat().UnrotateVector(Normal);
+	const FRotator Tilt = FRotationMatrix::MakeFromZX(LocalNormal, FVector::ForwardVector).Rotator();
+
+	OutTilt = FRotator(
+		FMath::Clamp(Tilt.Pitch, -MaxTiltAngle, MaxTiltAngle),
+		0.0f,
+		FMath::Clamp(Tilt.Roll, -MaxTiltAngle, MaxTiltAngle));
+
+	return true;
+}
+
+void USkateBoardAlignmentComponent::IssueWheelTraces(float DeltaTime)
+{
+	const UCapsuleComponent* Capsule = SkateCharacter->GetCapsuleComponent();
+	const UMauriSkateMovementComponent* Movement = SkateCharacter->GetSkateMovement();
+
+	// aim at where the board will be when the results are read
+	const FTransform& CapsuleTransform = Capsule->GetComponentTransform();
+	const FVector Bottom = CapsuleTransform.GetLocation() + Movement->Velocity * DeltaTime - FVector(0.0f, 0.0f, Capsule->GetScaledCapsuleHalfHeight());
+
+	const FVector2D WheelOffsets[NumWheels] =
+	{
+		FVector2D(WheelBase, -WheelTrack),
+		FVector2D(WheelBase, WheelTrack),
+		FVector2D(-WheelBase, -WheelTrack),
+		FVector2D(-WheelBase, WheelTrack)
+	};
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SkateBoardAlignment), false, SkateCharacter);
+	FCollisionResponseParams ResponseParams;
+	Capsule->InitSweepCollisionParams(QueryParams, ResponseParams);
+
+	++IssuedBatch;
+
+	for (int32 Wheel = 0; Wheel < NumWheels; ++Wheel)
+	{
+		const FVector Wheel2D = CapsuleTransform.GetRotation().RotateVector(FVector(WheelOffsets[Wheel], 0.0f));
+		const FVector Start = Bottom + Wheel2D + FVector(0.0f, 0.0f, TraceHeight);
+		const FVector End = Bottom + Wheel2D - FVector(0.0f, 0.0f, TraceDepth);
+
+		GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, Capsule->GetCollisionObjectType(),
+			QueryParams, ResponseParams, &WheelTraceDelegate, (IssuedBatch << SkateBoardAlignment::WheelBits) | Wheel);
+	}
+}
+
+void USkateBoardAlignmentComponent::OnWheelTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	const uint32 Batch = TraceDatum.UserData >> SkateBoardAlignment::WheelBits;
+	const int32 Wheel = TraceDatum.UserData & SkateBoardAlignment::WheelMask;
+
+	// the first result of a batch clears the previous one
+	if (Batch != ContactBatch)
+	{
+		ContactBatch = Batch;
+
+		for (FWheelContact& Contact : WheelContacts)
+		{
+			Contact.bHit = false;
+		}
+	}
+
+	const FHitResult* Hit = TraceDatum.OutHits.FindByPredicate([](const FHitResult& Result) { return Result.bBlockingHit; });
+	WheelContacts[Wheel].bHit = Hit != nullptr;
+	WheelContacts[Wheel].Point = Hit ? Hit->ImpactPoint : FVector::ZeroVector;
+}
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "WorldCollision.h"
+#include "SkateBoardAlignmentComponent.generated.h"
+
+class AMauriSkateCharacter;
+
+/**
+ *  Tilts the skateboard to the floor under its four wheels.
+ *  Every frame it consumes the wheel traces issued on the previous frame and issues the next batch, so it never
+ *  runs a physics query synchronously. The wheel contacts are fitted to a plane, and its pitch and roll are smoothed
+ *  by a critically damped spring before they reach the board mesh and the animation instance.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class MAURISKATE_API USkateBoardAlignmentComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Distance from the board center to the front and back wheels */
+	UPROPERTY(EditAnywhere, Category="Skate|Board Alignment", meta = (ClampMin = 1, Units = "cm"))
+	float WheelBase = 40.0f;
+
+	/** Distance from the board center to the left and right wheels */
+	UPROPERTY(EditAnywhere, Category="Skate|Board Alignment", meta = (ClampMin = 1, Units = "cm"))
+	float WheelTrack = 12.0f;
+
+	/** How far above the capsule bottom the wheel traces start */
+	UPROPERTY(EditAnywhere, Category="Skate|Board Alignment", meta = (ClampMin = 0, Units = "cm"))
+	float TraceHeight = 30.0f;
+
+	/** How far below the capsule bottom the wheel traces reach */
+	UPROPERTY(EditAnywhere, Category="Skate|Board Alignment", meta = (ClampMin = 0, Units = "cm"))
+	float TraceDepth = 40.0f;
+
+	/** Time the spring takes to mostly catch up with the floor */
+	UPROPERTY(EditAnywhere, Category="Skate|Board Alignment", meta = (ClampMin = 0.01, Units = "s"))
+	float SmoothingTime = 0.12f;
+
+	/** Largest pitch or roll the board takes */
+	UPROPERTY(EditAnywhere, Category="Skate|Board Alignment", meta = (ClampMin = 0, ClampMax = 80, Units = "Degrees"))
+	float MaxTiltAngle = 35.0f;
+
+	/** Constructor */
+	USkateBoardAlignmentComponent();
+
+	/** Returns the smoothed board pitch and roll, relative to the capsule */
+	UFUNCTION(BlueprintPure, Category="Skate|Board Alignment")
+	FRotator GetBoardTilt() const { return FRotator(BoardPitch, 0.0f, BoardRoll); }
+
+	// ~begin UActorComponent interface
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	// ~end UActorComponent interface
+
+protected:
+
+	/** Fits the wheel contacts from the last batch and returns the target pitch and roll. False if too few wheels hit */
+	bool FitBoardTilt(FRotator& OutTilt) const;
+
+	/** Issues this frame's wheel traces */
+	void IssueWheelTraces(float DeltaTime);
+
+	/** Stores a wheel trace result */
+	void OnWheelTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+private:
+
+	/** Wheels, in front left, front right, back left, back right order */
+	static constexpr int32 NumWheels = 4;
+
+	/** Where a wheel touched the floor */
+	struct FWheelContact
+	{
+		FVector Point = FVector::ZeroVector;
+		bool bHit = false;
+	};
+
+	/** Owning skate character */
+	UPROPERTY(Transient)
+	TObjectPtr<AMauriSkateCharacter> SkateCharacter;
+
+	/** Callback for the wheel traces */
+	FTraceDelegate WheelTraceDelegate;
+
+	/** Results of the last batch */
+	FWheelContact WheelContacts[NumWheels];
+
+	/** Batch the stored results belong to, and the last one issued */
+	uint32 ContactBatch = 0;
+	uint32 IssuedBatch = 0;
+
+	/** Smoothed tilt, in degrees, and its rate of change */
+	float BoardPitch = 0.0f;
+	float BoardRoll = 0.0f;
+	float BoardPitchRate = 0.0f;
+	float BoardRollRate = 0.0f;
+};
@@ -0,0 +1,245 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SkateCrowdManager.h"
+#include "MauriSkateCharacter.h"
+#include "MauriSkateMovementComponent.h"
+#include "SkateTelemetry.h"
+#include "Async/ParallelFor.h"
+#include "Components/BoxComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Crowd Update"), STAT_SkateCrowdUpdate, STATGROUP_Skate);
+
+ASkateCrowdManager::ASkateCrowdManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	CrowdArea = CreateDefaultSubobject<UBoxComponent>(TEXT("CrowdArea"));
+	CrowdArea->SetBoxExtent(FVector(2000.0f, 2000.0f, 100.0f));
+	CrowdArea->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	RootComponent = CrowdArea;
+
+	SkaterInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("SkaterInstances"));
+	SkaterInstances->SetupAttachment(CrowdArea);
+	SkaterInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SkaterInstances->SetCanEverAffectNavigation(false);
+
+	BoardInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("BoardInstances"));
+	BoardInstances->SetupAttachment(CrowdArea);
+	BoardInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	BoardInstances->SetCanEverAffectNavigation(false);
+
+	FloorProbeDelegate.BindUObject(this, &ASkateCrowdManager::OnFloorProbeDone);
+}
+
+void ASkateCrowdManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// share the player's tuning so the crowd pushes, brakes and slides the same way
+	if (SkaterTuning)
+	{
+		const AMauriSkateCharacter* Template = SkaterTuning->GetDefaultObject<AMauriSkateCharacter>();
+		SimParams = Template->GetSkateMovement()->BuildSkateSimParams(*Template, GetWorld()->GetGravityZ());
+	}
+	else
+	{
+		SimParams.GravityZ = GetWorld()->GetGravityZ();
+	}
+
+	SimParams.FixedStep = 1.0f / SimulationRate;
+	SimParams.MaxStepsPerFrame = MaxStepsPerFrame;
+
+	SpawnCrowd();
+
+	// find every floor once up front, then keep refreshing them a few at a time
+	ProbeFloors(Positions.Num());
+}
+
+void ASkateCrowdManager::SpawnCrowd()
+{
+	const FBox Area = CrowdArea->Bounds.GetBox();
+	FRandomStream Stream(GetTypeHash(GetName()));
+
+	Positions.SetNumUninitialized(NumSkaters);
+	Headings.SetNumUninitialized(NumSkaters);
+	PreviousPositions.SetNumUninitialized(NumSkaters);
+	PreviousHeadings.SetNumUninitialized(NumSkaters);
+	Speeds.SetNumZeroed(NumSkaters);
+	PushTimers.SetNumZeroed(NumSkaters);
+	PushImpulsesApplied.SetNumZeroed(NumSkaters);
+	TargetHeadings.SetNumUninitialized(NumSkaters);
+	WanderTimers.SetNumUninitialized(NumSkaters);
+	FloorPoints.SetNumUninitialized(NumSkaters);
+	FloorNormals.Init(FVector::UpVector, NumSkaters);
+	SkaterTransforms.SetNum(NumSkaters);
+	BoardTransforms.SetNum(NumSkaters);
+
+	for (int32 Index = 0; Index < NumSkaters; ++Index)
+	{
+		Positions[Index] = FVector(Stream.FRandRange(Area.Min.X, Area.Max.X), Stream.FRandRange(Area.Min.Y, Area.Max.Y), GetActorLocation().Z);
+		Headings[Index] = Stream.FRandRange(-180.0f, 180.0f);
+		TargetHeadings[Index] = Headings[Index];
+		WanderTimers[Index] = Stream.FRandRange(0.0f, WanderInterval);
+		FloorPoints[Index] = Positions[Index];
+		PreviousPositions[Index] = Positions[Index];
+		PreviousHeadings[Index] = Headings[Index];
+	}
+
+	UpdateInstances(1.0f);
+
+	SkaterInstances->ClearInstances();
+	SkaterInstances->AddInstances(SkaterTransforms, false, true);
+
+	BoardInstances->ClearInstances();
+	BoardInstances->AddInstances(BoardTransforms, false, true);
+}
+
+void ASkateCrowdManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	SCOPE_CYCLE_COUNTER(STAT_SkateCrowdUpdate);
+
+	if (Positions.IsEmpty())
+	{
+		return;
+	}
+
+	const int32 NumSteps = SimAccumulator.Consume(DeltaSeconds, SimParams);
+	if (NumSteps > 0)
+	{
+		SimulateCrowd(NumSteps);
+	}
+
+	// the crowd steps slower than the frame rate, so blend between steps every frame like the player skate does
+	UpdateInstances(SimAccumulator.GetAlpha(SimParams));
+
+	SkaterInstances->BatchUpdateInstancesTransforms(0, SkaterTransforms, true, true);
+	BoardInstances->BatchUpdateInstancesTransforms(0, BoardTransforms, true, true);
+
+	ProbeFloors(FloorProbesPerFrame);
+}
+
+void ASkateCrowdManager::SimulateCrowd(int32 NumSteps)
+{
+	const FBox Area = CrowdArea->Bounds.GetBox();
+	const FVector AreaCenter = Area.GetCenter();
+	const float StepTime = SimParams.FixedStep;
+	const uint32 FirstStep = StepCounter;
+	StepCounter += NumSteps;
+
+	ParallelFor(TEXT("SkateCrowd"), Positions.Num(), SkatersPerTask, [&](int32 Index)
+	{
+		// gather this skater's lanes into the same state the player skate runs on
+		FSkateSimState State;
+		State.Location = Positions[Index];
+		State.Yaw = Headings[Index];
+		State.Velocity = FRotator(0.0f, State.Yaw, 0.0f).Vector() * Speeds[Index];
+		State.PushRemainingTime = PushTimers[Index];
+		State.bPushingInstantReached = PushImpulsesApplied[Index];
+
+		FSkateSimInput Input;
+		Input.bGrounded = true;
+		Input.FloorNormal = FloorNormals[Index];
+		Input.bHasTurnTarget = true;
+
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			// pick a new heading every now and then, and head back in when leaving the area
+			WanderTimers[Index] -= StepTime;
+			if (WanderTimers[Index] <= 0.0f)
+			{
+				FRandomStream Stream(HashCombineFast(GetTypeHash(Index), GetTypeHash(FirstStep + Step)));
+
+				if (Area.IsInsideXY(State.Location))
+				{
+					TargetHeadings[Index] = FRotator::NormalizeAxis(State.Yaw + Stream.FRandRange(-WanderAngle, WanderAngle));
+				}
+				else
+				{
+					TargetHeadings[Index] = (AreaCenter - State.Location).Rotation().Yaw;
+				}
+
+				WanderTimers[Index] = WanderInterval * Stream.FRandRange(0.5f, 1.5f);
+			}
+
+			Input.TurnTargetYaw = TargetHeadings[Index];
+			Input.bPushRequested = State.Velocity.Size2D() < CruiseSpeed;
+
+			// only the last step of the frame is interpolated across
+			if (Step == NumSteps - 1)
+			{
+				PreviousPositions[Index] = State.Location;
+				PreviousHeadings[Index] = State.Yaw;
+			}
+
+			FSkateSimStep::Advance(State, Input, SimParams);
+		}
+
+		// ground movement is horizontal, put the feet back on the floor plane
+		const FVector& FloorPoint = FloorPoints[Index];
+		const FVector& FloorNormal = FloorNormals[Index];
+		if (FloorNormal.Z > UE_KINDA_SMALL_NUMBER)
+		{
+			State.Location.Z = FloorPoint.Z - (FloorNormal.X * (State.Location.X - FloorPoint.X) + FloorNormal.Y * (State.Location.Y - FloorPoint.Y)) / FloorNormal.Z;
+		}
+
+		// scatter back
+		Positions[Index] = State.Location;
+		Headings[Index] = State.Yaw;
+		Speeds[Index] = State.Velocity | FRotator(0.0f, State.Yaw, 0.0f).Vector();
+		PushTimers[Index] = State.PushRemainingTime;
+		PushImpulsesApplied[Index] = State.bPushingInstantReached;
+	});
+}
+
+void ASkateCrowdManager::UpdateInstances(float Alpha)
+{
+	ParallelFor(TEXT("SkateCrowdInstances"), Positions.Num(), SkatersPerTask, [&](int32 Index)
+	{
+		const FVector Position = FMath::Lerp(PreviousPositions[Index], Positions[Index], Alpha);
+		const float Heading = PreviousHeadings[Index] + FRotator::NormalizeAxis(Headings[Index] - PreviousHeadings[Index]) * Alpha;
+
+		// lean the skater with the floor so they follow ramps
+		const FVector Forward = FVector::VectorPlaneProject(FRotator(0.0f, Heading, 0.0f).Vector(), FloorNormals[Index]);
+		const FQuat Rotation = FRotationMatrix::MakeFromXZ(Forward, FloorNormals[Index]).ToQuat();
+
+		SkaterTransforms[Index] = FTransform(Rotation, Position);
+		BoardTransforms[Index] = BoardTransform * SkaterTransforms[Index];
+	});
+}
+
+void ASkateCrowdManager::ProbeFloors(int32 NumProbes)
+{
+	UWorld* World = GetWorld();
+	NumProbes = FMath::Min(NumProbes, Positions.Num());
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SkateCrowdFloor), false, this);
+
+	for (int32 Probe = 0; Probe < NumProbes; ++Probe)
+	{
+		NextFloorProbe = (NextFloorProbe + 1) % Positions.Num();
+
+		const FVector& Location = Positions[NextFloorProbe];
+		const FVector Reach = FVector::UpVector * FloorProbeReach;
+
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Location + Reach, Location - Reach, ECC_Visibility, QueryParams, FCollisionResponseParams::DefaultResponseParam, &FloorProbeDelegate, NextFloorProbe);
+	}
+}
+
+void ASkateCrowdManager::OnFloorProbeDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	const int32 Index = static_cast<int32>(TraceDatum.UserData);
+
+	if (!FloorPoints.IsValidIndex(Index) || TraceDatum.OutHits.IsEmpty() || !TraceDatum.OutHits[0].bBlockingHit)
+	{
+		// nothing under us, keep rolling on the last floor we saw
+		return;
+	}
+
+	FloorPoints[Index] = TraceDatum.OutHits[0].ImpactPoint;
+	FloorNormals[Index] = TraceDatum.OutHits[0].ImpactNormal;
+}
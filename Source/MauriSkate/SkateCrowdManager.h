@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SkateSimulation.h"
+#include "WorldCollision.h"
+#include "SkateCrowdManager.generated.h"
+
+class AMauriSkateCharacter;
+class UBoxComponent;
+class UInstancedStaticMeshComponent;
+
+/**
+ *  Simulates and draws a crowd of ambient skaters without spawning characters.
+ *  Skater state is kept as parallel arrays and advanced in one ParallelFor pass with the same FSkateSimStep rules as the player.
+ *  Floors are found with a capped number of round-robin async traces per frame, and skaters are drawn as mesh instances.
+ *  Crowd skaters don't collide with the world or each other, they wander inside the spawn area.
+ */
+UCLASS()
+class MAURISKATE_API ASkateCrowdManager : public AActor
+{
+	GENERATED_BODY()
+
+	/** Area the skaters spawn and wander in */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UBoxComponent* CrowdArea;
+
+	/** One instance per skater body */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UInstancedStaticMeshComponent* SkaterInstances;
+
+	/** One instance per board */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UInstancedStaticMeshComponent* BoardInstances;
+
+protected:
+
+	/** Skate character class the push, friction and ramp tuning is read from */
+	UPROPERTY(EditAnywhere, Category="Crowd")
+	TSubclassOf<AMauriSkateCharacter> SkaterTuning;
+
+	/** Number of skaters */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, ClampMax = 4096))
+	int32 NumSkaters = 200;
+
+	/** Rate the crowd is simulated at. Lower than the player since nobody looks at them closely */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 5, ClampMax = 120, Units = "Hz"))
+	float SimulationRate = 30.0f;
+
+	/** Max simulation steps per frame. Keeps the cost bounded after a hitch */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 1, ClampMax = 8))
+	int32 MaxStepsPerFrame = 2;
+
+	/** Skaters push whenever they drop below this speed */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, Units = "cm/s"))
+	float CruiseSpeed = 500.0f;
+
+	/** Average time between heading changes */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0.1, Units = "s"))
+	float WanderInterval = 3.0f;
+
+	/** Max heading change when wandering */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 0, ClampMax = 180, Units = "deg"))
+	float WanderAngle = 60.0f;
+
+	/** Async floor traces issued per frame. Each skater's floor is refreshed every NumSkaters / FloorProbesPerFrame frames */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 1))
+	int32 FloorProbesPerFrame = 32;
+
+	/** How far above and below the skater the floor traces reach */
+	UPROPERTY(EditAnywhere, Category="Crowd", meta = (ClampMin = 1, Units = "cm"))
+	float FloorProbeReach = 200.0f;
+
+	/** Board instance transform, relative to the skater's feet */
+	UPROPERTY(EditAnywhere, Category="Crowd")
+	FTransform BoardTransform;
+
+	/** Skaters simulated per ParallelFor task */
+	UPROPERTY(EditAnywhere, Category="Crowd|Performance", meta = (ClampMin = 1))
+	int32 SkatersPerTask = 64;
+
+public:
+
+	/** Constructor */
+	ASkateCrowdManager();
+
+	/** Returns the number of skaters currently simulated */
+	int32 GetNumCrowdSkaters() const { return Positions.Num(); }
+
+	// ~begin AActor interface
+	virtual void Tick(float DeltaSeconds) override;
+	// ~end AActor interface
+
+protected:
+
+	// ~begin AActor interface
+	virtual void BeginPlay() override;
+	// ~end AActor interface
+
+	/** Places the skaters and creates their instances */
+	void SpawnCrowd();
+
+	/** Advances every skater by the provided number of steps */
+	void SimulateCrowd(int32 NumSteps);
+
+	/** Builds the instance transforms, Alpha of the way from the previous step to the current one */
+	void UpdateInstances(float Alpha);
+
+	/** Issues this frame's floor traces */
+	void ProbeFloors(int32 NumProbes);
+
+	/** Async trace callback, stores the floor for the skater in the user data */
+	void OnFloorProbeDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+private:
+
+	/** Feet location */
+	TArray<FVector> Positions;
+
+	/** Board facing yaw, in degrees */
+	TArray<float> Headings;
+
+	/** Feet location and heading before the last step, to interpolate from between steps */
+	TArray<FVector> PreviousPositions;
+	TArray<float> PreviousHeadings;
+
+	/** Signed speed along the heading. Negative while rolling backwards */
+	TArray<float> Speeds;
+
+	/** Push animation time left */
+	TArray<float> PushTimers;
+
+	/** True once the current push impulse was applied */
+	TArray<bool> PushImpulsesApplied;
+
+	/** Heading the skater is turning towards */
+	TArray<float> TargetHeadings;
+
+	/** Time left until the next heading change */
+	TArray<float> WanderTimers;
+
+	/** A point on the floor last found under the skater */
+	TArray<FVector> FloorPoints;
+
+	/** Normal of the floor last found under the skater */
+	TArray<FVector> FloorNormals;
+
+	/** Scratch transforms for the instance update */
+	TArray<FTransform> SkaterTransforms;
+	TArray<FTransform> BoardTransforms;
+
+	/** Tuning shared by every crowd skater */
+	FSkateSimParams SimParams;
+
+	/** Turns frame time into fixed steps */
+	FSkateSimAccumulator SimAccumulator;
+
+	/** Callback for the floor traces */
+	FTraceDelegate FloorProbeDelegate;
+
+	/** Next skater to get a floor trace */
+	int32 NextFloorProbe = 0;
+
+	/** Steps simulated so far. Seeds the wandering */
+	uint32 StepCounter = 0;
+};
@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SkateGhostData.h"
+
+namespace SkateGhost
+{
+	void WriteVarUInt(TArray<uint8>& Out, uint32 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add(static_cast<uint8>(Value) | 0x80);
+			Value >>= 7;
+		}
+
+		Out.Add(static_cast<uint8>(Value));
+	}
+
+	void WriteVarInt(TArray<uint8>& Out, int32 Value)
+	{
+		// zig-zag so small negative deltas stay small
+		WriteVarUInt(Out, (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31));
+	}
+
+	bool ReadVarUInt(const uint8*& Cursor, const uint8* End, uint32& OutValue)
+	{
+		OutValue = 0;
+
+		for (int32 Shift = 0; Shift < 35; Shift += 7)
+		{
+			if (Cursor >= End)
+			{
+				return false;
+			}
+
+			const uint8 Byte = *Cursor++;
+			OutValue |= static_cast<uint32>(Byte & 0x7F) << Shift;
+
+			if ((Byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+
+		// malformed, more than 5 bytes
+		return false;
+	}
+
+	bool ReadVarInt(const uint8*& Cursor, const uint8* End, int32& OutValue)
+	{
+		uint32 Encoded;
+		if (!ReadVarUInt(Cursor, End, Encoded))
+		{
+			return false;
+		}
+
+		OutValue = static_cast<int32>(Encoded >> 1) ^ -static_cast<int32>(Encoded & 1);
+		return true;
+	}
+}
+
+FSkateGhostFrame FSkateGhostFrame::Interpolate(const FSkateGhostFrame& A, const FSkateGhostFrame& B, float Alpha)
+{
+	FSkateGhostFrame Result;
+	Result.Location = FMath::Lerp(A.Location, B.Location, Alpha);
+	Result.Yaw = A.Yaw + FRotator::NormalizeAxis(B.Yaw - A.Yaw) * Alpha;
+	Result.Speed = FMath::Lerp(A.Speed, B.Speed, Alpha);
+
+	// the push phase wraps back to zero when a new push starts, don't blend across that
+	Result.PushPhase = B.PushPhase >= A.PushPhase ? FMath::Lerp(A.PushPhase, B.PushPhase, Alpha) : B.PushPhase;
+	Result.bIsJumping = Alpha < 0.5f ? A.bIsJumping : B.bIsJumping;
+
+	return Result;
+}
+
+FSkateGhostQuantizedFrame FSkateGhostQuantizedFrame::Quantize(const FSkateGhostFrame& Frame)
+{
+	FSkateGhostQuantizedFrame Result;
+	Result.X = FMath::RoundToInt32(Frame.Location.X);
+	Result.Y = FMath::RoundToInt32(Frame.Location.Y);
+	Result.Z = FMath::RoundToInt32(Frame.Location.Z);
+	Result.Yaw = FRotator::CompressAxisToShort(Frame.Yaw);
+	Result.Speed = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt32(Frame.Speed), 0, MAX_uint16));
+	Result.PushPhase = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt32(Frame.PushPhase * 255.0f), 0, 255));
+	Result.Flags = Frame.bIsJumping ? FLAG_Jumping : 0;
+
+	return Result;
+}
+
+FSkateGhostFrame FSkateGhostQuantizedFrame::Dequantize() const
+{
+	FSkateGhostFrame Result;
+	Result.Location = FVector(X, Y, Z);
+	Result.Yaw = FRotator::DecompressAxisFromShort(Yaw);
+	Result.Speed = Speed;
+	Result.PushPhase = PushPhase / 255.0f;
+	Result.bIsJumping = (Flags & FLAG_Jumping) != 0;
+
+	return Result;
+}
+
+bool FSkateGhostHeader::Serialize(FArchive& Ar)
+{
+	uint32 FileMagic = Magic;
+	Ar << FileMagic;
+	Ar << Version;
+
+	if (FileMagic != Magic || Version != CurrentVersion)
+	{
+		return false;
+	}
+
+	Ar << SampleRate;
+	Ar << LevelName;
+
+	return !Ar.IsError();
+}
+
+void FSkateGhostCodec::EncodeChunk(TConstArrayView<FSkateGhostQuantizedFrame> Frames, TArray<uint8>& OutBytes)
+{
+	using namespace SkateGhost;
+
+	TArray<uint8> Payload;
+	Payload.Reserve(Frames.Num() * 8);
+
+	WriteVarUInt(Payload, Frames.Num());
+
+	FSkateGhostQuantizedFrame Previous;
+	for (const FSkateGhostQuantizedFrame& Frame : Frames)
+	{
+		WriteVarInt(Payload, Frame.X - Previous.X);
+		WriteVarInt(Payload, Frame.Y - Previous.Y);
+		WriteVarInt(Payload, Frame.Z - Previous.Z);
+
+		// the yaw wraps around, so the shortest delta always fits a short
+		WriteVarInt(Payload, static_cast<int16>(Frame.Yaw - Previous.Yaw));
+
+		WriteVarInt(Payload, static_cast<int32>(Frame.Speed) - Previous.Speed);
+		WriteVarInt(Payload, static_cast<int32>(Frame.PushPhase) - Previous.PushPhase);
+		Payload.Add(Frame.Flags);
+
+		Previous = Frame;
+	}
+
+	WriteVarUInt(OutBytes, Payload.Num());
+	OutBytes.Append(Payload);
+}
+
+bool FSkateGhostCodec::DecodeChunks(TConstArrayView<uint8> Bytes, TArray<FSkateGhostQuantizedFrame>& OutFrames)
+{
+	using namespace SkateGhost;
+
+	const uint8* Cursor = Bytes.GetData();
+	const uint8* End = Cursor + Bytes.Num();
+
+	while (Cursor < End)
+	{
+		uint32 PayloadSize;
+		if (!ReadVarUInt(Cursor, End, PayloadSize) || PayloadSize > static_cast<uint32>(End - Cursor))
+		{
+			return false;
+		}
+
+		const uint8* ChunkEnd = Cursor + PayloadSize;
+
+		uint32 NumFrames;
+		if (!ReadVarUInt(Cursor, ChunkEnd, NumFrames))
+		{
+			return false;
+		}
+
+		// decode into scratch first, so a bad chunk doesn't leave half a chunk behind
+		TArray<FSkateGhostQuantizedFrame, TInlineAllocator<64>> ChunkFrames;
+		ChunkFrames.Reserve(FMath::Min<uint32>(NumFrames, PayloadSize));
+
+		FSkateGhostQuantizedFrame Frame;
+		for (uint32 Index = 0; Index < NumFrames; ++Index)
+		{
+			int32 DX, DY, DZ, DYaw, DSpeed, DPushPhase;
+			if (!ReadVarInt(Cursor, ChunkEnd, DX) ||
+				!ReadVarInt(Cursor, ChunkEnd, DY) ||
+				!ReadVarInt(Cursor, ChunkEnd, DZ) ||
+				!ReadVarInt(Cursor, ChunkEnd, DYaw) ||
+				!ReadVarInt(Cursor, ChunkEnd, DSpeed) ||
+				!ReadVarInt(Cursor, ChunkEnd, DPushPhase) ||
+				Cursor >= ChunkEnd)
+			{
+				return false;
+			}
+
+			Frame.X += DX;
+			Frame.Y += DY;
+			Frame.Z += DZ;
+			Frame.Yaw = static_cast<uint16>(Frame.Yaw + DYaw);
+			Frame.Speed = static_cast<uint16>(Frame.Speed + DSpeed);
+			Frame.PushPhase = static_cast<uint8>(Frame.PushPhase + DPushPhase);
+			Frame.Flags = *Cursor++;
+
+			ChunkFrames.Add(Frame);
+		}
+
+		OutFrames.Append(ChunkFrames);
+		Cursor = ChunkEnd;
+	}
+
+	return true;
+}
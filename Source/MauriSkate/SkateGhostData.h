@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ *  One sample of a recorded skate run, in world units
+ */
+struct MAURISKATE_API FSkateGhostFrame
+{
+	FVector Location = FVector::ZeroVector;
+	float Yaw = 0.0f;
+	float Speed = 0.0f;
+	float PushPhase = 0.0f;
+	bool bIsJumping = false;
+
+	/** Blends two frames, taking the shortest way around for the yaw */
+	static FSkateGhostFrame Interpolate(const FSkateGhostFrame& A, const FSkateGhostFrame& B, float Alpha);
+};
+
+/**
+ *  A ghost frame quantized for storage.
+ *  Location in centimeters, yaw as a short angle, speed in cm/s and push phase in 1/255 steps.
+ */
+struct MAURISKATE_API FSkateGhostQuantizedFrame
+{
+	int32 X = 0;
+	int32 Y = 0;
+	int32 Z = 0;
+	uint16 Yaw = 0;
+	uint16 Speed = 0;
+	uint8 PushPhase = 0;
+	uint8 Flags = 0;
+
+	/** Flag bits */
+	static constexpr uint8 FLAG_Jumping = 1 << 0;
+
+	/** Quantizes a frame */
+	static FSkateGhostQuantizedFrame Quantize(const FSkateGhostFrame& Frame);
+
+	/** Expands back to world units */
+	FSkateGhostFrame Dequantize() const;
+};
+
+/** Header written at the start of every ghost file */
+struct MAURISKATE_API FSkateGhostHeader
+{
+	static constexpr uint32 Magic = 0x48474B53; // "SKGH"
+	static constexpr uint32 CurrentVersion = 1;
+
+	uint32 Version = CurrentVersion;
+
+	/** Frames per second the run was sampled at */
+	float SampleRate = 30.0f;
+
+	/** Level the run was recorded on */
+	FString LevelName;
+
+	/** Serializes the header. Returns false if the magic or version don't match */
+	bool Serialize(FArchive& Ar);
+};
+
+/**
+ *  Chunked delta + varint codec for ghost runs.
+ *  Each chunk starts from a zero frame, so chunks decode on their own and a truncated file still plays up to its last full chunk.
+ *  Fields are stored as zig-zag varints of the difference to the previous frame, which is one byte for most of them at skating speeds.
+ */
+struct MAURISKATE_API FSkateGhostCodec
+{
+	/** Appends one encoded chunk, including its size prefix */
+	static void EncodeChunk(TConstArrayView<FSkateGhostQuantizedFrame> Frames, TArray<uint8>& OutBytes);
+
+	/** Decodes every chunk in the provided bytes. Returns false if the data ends mid chunk, keeping the frames decoded so far */
+	static bool DecodeChunks(TConstArrayView<uint8> Bytes, TArray<FSkateGhostQuantizedFrame>& OutFrames);
+};
@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SkateGhostPawn.h"
+#include "MauriSkate.h"
+#include "SkateGhostRecorderComponent.h"
+#include "Async/Async.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+
+ASkateGhostPawn::ASkateGhostPawn()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	// ghosts are purely visual
+	SetActorEnableCollision(false);
+	AutoPossessAI = EAutoPossessAI::Disabled;
+	AIControllerClass = nullptr;
+
+	GhostRoot = CreateDefaultSubobject<USceneComponent>(TEXT("GhostRoot"));
+	RootComponent = GhostRoot;
+
+	Mesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("Mesh"));
+	Mesh->SetupAttachment(GhostRoot);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetGenerateOverlapEvents(false);
+	Mesh->SetCanEverAffectNavigation(false);
+	Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+
+	SkateMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("SkateMesh"));
+	SkateMesh->SetupAttachment(Mesh);
+	SkateMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SkateMesh->SetGenerateOverlapEvents(false);
+	SkateMesh->SetCanEverAffectNavigation(false);
+}
+
+void ASkateGhostPawn::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!RunName.IsEmpty())
+	{
+		LoadRun(RunName);
+	}
+}
+
+void ASkateGhostPawn::LoadRun(const FString& InRunName)
+{
+	RunName = InRunName;
+
+	const uint32 Serial = ++LoadSerial;
+	const FString Path = USkateGhostRecorderComponent::GetGhostFilePath(InRunName);
+	TWeakObjectPtr<ASkateGhostPawn> WeakThis(this);
+
+	// read and decode off the game thread, then hand the frames back
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Serial, Path]()
+	{
+		TArray<uint8> Bytes;
+		if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+		{
+			UE_LOG(LogMauriSkate, Warning, TEXT("Couldn't read ghost file %s"), *Path);
+			return;
+		}
+
+		FSkateGhostHeader Header;
+		FMemoryReader Reader(Bytes);
+		if (!Header.Serialize(Reader))
+		{
+			UE_LOG(LogMauriSkate, Warning, TEXT("%s is not a ghost run, or was recorded by another version"), *Path);
+			return;
+		}
+
+		TArray<FSkateGhostQuantizedFrame> QuantizedFrames;
+		if (!FSkateGhostCodec::DecodeChunks(TConstArrayView<uint8>(Bytes).RightChop(static_cast<int32>(Reader.Tell())), QuantizedFrames))
+		{
+			// the recording was cut short, play what we have
+			UE_LOG(LogMauriSkate, Warning, TEXT("Ghost file %s is truncated"), *Path);
+		}
+
+		TArray<FSkateGhostFrame> LoadedFrames;
+		LoadedFrames.Reserve(QuantizedFrames.Num());
+		for (const FSkateGhostQuantizedFrame& Frame : QuantizedFrames)
+		{
+			LoadedFrames.Add(Frame.Dequantize());
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Serial, Header = MoveTemp(Header), LoadedFrames = MoveTemp(LoadedFrames)]() mutable
+		{
+			if (ASkateGhostPawn* Ghost = WeakThis.Get())
+			{
+				if (Ghost->LoadSerial == Serial)
+				{
+					Ghost->OnRunLoaded(Header, MoveTemp(LoadedFrames));
+				}
+			}
+		});
+	});
+}
+
+void ASkateGhostPawn::OnRunLoaded(const FSkateGhostHeader& Header, TArray<FSkateGhostFrame>&& LoadedFrames)
+{
+	FString LevelName = GetWorld()->GetMapName();
+	LevelName.RemoveFromStart(GetWorld()->StreamingLevelsPrefix);
+
+	if (Header.LevelName != LevelName)
+	{
+		UE_LOG(LogMauriSkate, Warning, TEXT("Ghost run %s was recorded on %s, playing it on %s"), *RunName, *Header.LevelName, *LevelName);
+	}
+
+	Frames = MoveTemp(LoadedFrames);
+	FrameRate = FMath::Max(Header.SampleRate, 1.0f);
+	PlaybackTime = 0.0;
+}
+
+void ASkateGhostPawn::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (Frames.IsEmpty())
+	{
+		return;
+	}
+
+	PlaybackTime += DeltaSeconds * PlaybackRate;
+
+	const double Duration = (Frames.Num() - 1) / static_cast<double>(FrameRate);
+	if (PlaybackTime > Duration)
+	{
+		PlaybackTime = (bLoop && Duration > 0.0) ? FMath::Fmod(PlaybackTime, Duration) : Duration;
+	}
+
+	// find the two frames around the playback time
+	const double FrameTime = PlaybackTime * FrameRate;
+	const int32 Index = FMath::Clamp(FMath::FloorToInt32(FrameTime), 0, Frames.Num() - 1);
+	const int32 NextIndex = FMath::Min(Index + 1, Frames.Num() - 1);
+	const float Alpha = static_cast<float>(FrameTime - Index);
+
+	const FSkateGhostFrame Frame = FSkateGhostFrame::Interpolate(Frames[Index], Frames[NextIndex], Alpha);
+
+	SetActorLocationAndRotation(Frame.Location, FRotator(0.0f, Frame.Yaw, 0.0f));
+
+	Speed = Frame.Speed;
+	PushPhase = Frame.PushPhase;
+	bIsJumping = Frame.bIsJumping;
+}
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Pawn.h"
+#include "SkateGhostData.h"
+#include "SkateGhostPawn.generated.h"
+
+class USkeletalMeshComponent;
+class UStaticMeshComponent;
+
+/**
+ *  Plays back a recorded skate run.
+ *  Has no movement component and no collision: every tick only interpolates between two recorded frames
+ *  and moves the actor, so many ghosts can share the course with the player.
+ *  The playback state is exposed for the animation BP the same way the skate character exposes its own.
+ */
+UCLASS(abstract)
+class MAURISKATE_API ASkateGhostPawn : public APawn
+{
+	GENERATED_BODY()
+
+	/** Root the recorded location is applied to. Matches the skate character's capsule center */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	USceneComponent* GhostRoot;
+
+	/** Skater mesh */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	USkeletalMeshComponent* Mesh;
+
+	/** Board mesh */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UStaticMeshComponent* SkateMesh;
+
+protected:
+
+	/** Run to load on BeginPlay. Leave empty to load one later */
+	UPROPERTY(EditAnywhere, Category="Ghost")
+	FString RunName;
+
+	/** If true, the run starts over when it ends */
+	UPROPERTY(EditAnywhere, Category="Ghost")
+	bool bLoop = true;
+
+	/** Playback speed multiplier */
+	UPROPERTY(EditAnywhere, Category="Ghost", meta = (ClampMin = 0))
+	float PlaybackRate = 1.0f;
+
+public:
+
+	// Read only are exposed for the animation BP
+	UPROPERTY(BlueprintReadOnly, Category="Ghost")
+	float Speed = 0.0f;
+	UPROPERTY(BlueprintReadOnly, Category="Ghost")
+	float PushPhase = 0.0f;
+	UPROPERTY(BlueprintReadOnly, Category="Ghost")
+	bool bIsJumping = false;
+
+	/** Constructor */
+	ASkateGhostPawn();
+
+	/** Loads a run in the background. Playback starts as soon as it's ready */
+	UFUNCTION(BlueprintCallable, Category="Ghost")
+	void LoadRun(const FString& InRunName);
+
+	/** Returns true while a run is loaded and playing */
+	UFUNCTION(BlueprintPure, Category="Ghost")
+	bool IsPlaying() const { return Frames.Num() > 0; }
+
+	// ~begin AActor interface
+	virtual void Tick(float DeltaSeconds) override;
+	// ~end AActor interface
+
+protected:
+
+	// ~begin AActor interface
+	virtual void BeginPlay() override;
+	// ~end AActor interface
+
+	/** Takes over a freshly loaded run */
+	void OnRunLoaded(const FSkateGhostHeader& Header, TArray<FSkateGhostFrame>&& LoadedFrames);
+
+private:
+
+	/** Decoded run frames */
+	TArray<FSkateGhostFrame> Frames;
+
+	/** Rate the run was recorded at */
+	float FrameRate = 30.0f;
+
+	/** Time since playback started */
+	double PlaybackTime = 0.0;
+
+	/** Incremented on every load, so only the latest one is kept */
+	uint32 LoadSerial = 0;
+};
@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SkateGhostRecorderComponent.h"
+#include "MauriSkate.h"
+#include "MauriSkateCharacter.h"
+#include "MauriSkateMovementComponent.h"
+#include "Engine/World.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+
+/** Run file shared between the recorder and its write tasks */
+struct FSkateGhostFileWriter
+{
+	FString Path;
+	TUniquePtr<IFileHandle> Handle;
+};
+
+USkateGhostRecorderComponent::USkateGhostRecorderComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	// sample after movement so we record where the skater ended up this frame
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void USkateGhostRecorderComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bRecordOnBeginPlay)
+	{
+		StartRecording(GetOwner()->GetName());
+	}
+}
+
+void USkateGhostRecorderComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopRecording();
+
+	// make sure the file is closed before we go away
+	WritePipe.WaitUntilEmpty();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+FString USkateGhostRecorderComponent::GetGhostFilePath(const FString& InRunName)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Ghosts"), FPaths::MakeValidFileName(InRunName) + TEXT(".skghost"));
+}
+
+bool USkateGhostRecorderComponent::StartRecording(const FString& InRunName)
+{
+	StopRecording();
+
+	RunName = InRunName;
+	GhostWriter = MakeShared<FSkateGhostFileWriter>();
+	GhostWriter->Path = GetGhostFilePath(RunName);
+
+	PendingFrames.Reset(FramesPerChunk);
+	TimeUntilNextFrame = 0.0f;
+
+	FSkateGhostHeader Header;
+	Header.SampleRate = SampleRate;
+	Header.LevelName = GetWorld()->GetMapName();
+	Header.LevelName.RemoveFromStart(GetWorld()->StreamingLevelsPrefix);
+
+	TArray<uint8> HeaderBytes;
+	FMemoryWriter HeaderWriter(HeaderBytes);
+	Header.Serialize(HeaderWriter);
+
+	WritePipe.Launch(UE_SOURCE_LOCATION, [Writer = GhostWriter, HeaderBytes = MoveTemp(HeaderBytes)]()
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Writer->Path));
+
+		Writer->Handle.Reset(PlatformFile.OpenWrite(*Writer->Path));
+		if (!Writer->Handle)
+		{
+			UE_LOG(LogMauriSkate, Warning, TEXT("Couldn't open ghost file %s"), *Writer->Path);
+			return;
+		}
+
+		Writer->Handle->Write(HeaderBytes.GetData(), HeaderBytes.Num());
+	});
+
+	return true;
+}
+
+void USkateGhostRecorderComponent::StopRecording()
+{
+	if (!GhostWriter.IsValid())
+	{
+		return;
+	}
+
+	FlushChunk();
+
+	WritePipe.Launch(UE_SOURCE_LOCATION, [Writer = MoveTemp(GhostWriter)]()
+	{
+		Writer->Handle.Reset();
+	});
+}
+
+void USkateGhostRecorderComponent::DiscardRecording()
+{
+	if (!GhostWriter.IsValid())
+	{
+		return;
+	}
+
+	// drop the buffered frames instead of writing them
+	PendingFrames.Reset();
+
+	WritePipe.Launch(UE_SOURCE_LOCATION, [Writer = MoveTemp(GhostWriter)]()
+	{
+		Writer->Handle.Reset();
+		FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*Writer->Path);
+	});
+}
+
+void USkateGhostRecorderComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	// record at a fixed rate. Slow frames record the same state more than once
+	TimeUntilNextFrame -= DeltaTime;
+	while (TimeUntilNextFrame <= 0.0f)
+	{
+		RecordFrame();
+		TimeUntilNextFrame += 1.0f / SampleRate;
+	}
+}
+
+void USkateGhostRecorderComponent::RecordFrame()
+{
+	const AActor* Owner = GetOwner();
+
+	FSkateGhostFrame Frame;
+	Frame.Location = Owner->GetActorLocation();
+	Frame.Yaw = Owner->GetActorRotation().Yaw;
+	Frame.Speed = Owner->GetVelocity().Size2D();
+
+	if (const AMauriSkateCharacter* SkateCharacter = Cast<AMauriSkateCharacter>(Owner))
+	{
+		const UMauriSkateMovementComponent* SkateMovement = SkateCharacter->GetSkateMovement();
+		Frame.PushPhase = SkateMovement->GetSkateSimState().GetPushPhase(SkateMovement->GetSkateSimParams());
+		Frame.bIsJumping = SkateCharacter->bIsJumping;
+	}
+
+	PendingFrames.Add(FSkateGhostQuantizedFrame::Quantize(Frame));
+
+	if (PendingFrames.Num() >= FramesPerChunk)
+	{
+		FlushChunk();
+	}
+}
+
+void USkateGhostRecorderComponent::FlushChunk()
+{
+	if (PendingFrames.IsEmpty() || !GhostWriter.IsValid())
+	{
+		return;
+	}
+
+	TArray<uint8> ChunkBytes;
+	FSkateGhostCodec::EncodeChunk(PendingFrames, ChunkBytes);
+
+	// reuse the buffer for the next chunk
+	PendingFrames.Reset();
+
+	WritePipe.Launch(UE_SOURCE_LOCATION, [Writer = GhostWriter, ChunkBytes = MoveTemp(ChunkBytes)]()
+	{
+		if (Writer->Handle)
+		{
+			Writer->Handle->Write(ChunkBytes.GetData(), ChunkBytes.Num());
+		}
+	});
+}
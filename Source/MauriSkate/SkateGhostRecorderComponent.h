@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SkateGhostData.h"
+#include "Tasks/Pipe.h"
+#include "SkateGhostRecorderComponent.generated.h"
+
+struct FSkateGhostFileWriter;
+
+/**
+ *  Records the owning skater at a fixed rate into a ghost run file.
+ *  Frames are quantized into a preallocated buffer and, once a chunk is full, delta encoded and
+ *  handed to a background pipe that appends it to disk. Recording never touches the disk on the game thread.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class MAURISKATE_API USkateGhostRecorderComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Frames recorded per second */
+	UPROPERTY(EditAnywhere, Category="Ghost", meta = (ClampMin = 1, ClampMax = 120, Units = "Hz"))
+	float SampleRate = 30.0f;
+
+	/** Frames encoded and written together. Also how much of the run is lost if the game dies mid recording */
+	UPROPERTY(EditAnywhere, Category="Ghost", meta = (ClampMin = 8, ClampMax = 1024))
+	int32 FramesPerChunk = 150;
+
+	/** If true, a run named after the owner starts recording on BeginPlay */
+	UPROPERTY(EditAnywhere, Category="Ghost")
+	bool bRecordOnBeginPlay = false;
+
+public:
+
+	/** Constructor */
+	USkateGhostRecorderComponent();
+
+	/** Starts recording into the named run, replacing any previous file with that name */
+	UFUNCTION(BlueprintCallable, Category="Ghost")
+	bool StartRecording(const FString& InRunName);
+
+	/** Writes the frames left over and closes the run file */
+	UFUNCTION(BlueprintCallable, Category="Ghost")
+	void StopRecording();
+
+	/** Stops recording and deletes the run file, for runs that are abandoned before they finish */
+	UFUNCTION(BlueprintCallable, Category="Ghost")
+	void DiscardRecording();
+
+	/** Returns true while recording */
+	UFUNCTION(BlueprintPure, Category="Ghost")
+	bool IsRecording() const { return GhostWriter.IsValid(); }
+
+	/** Returns the name of the run being recorded, or of the last one recorded */
+	UFUNCTION(BlueprintPure, Category="Ghost")
+	const FString& GetRunName() const { return RunName; }
+
+	/** Returns the file a run with the provided name is stored in */
+	static FString GetGhostFilePath(const FString& InRunName);
+
+	// ~begin UActorComponent interface
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	// ~end UActorComponent interface
+
+protected:
+
+	// ~begin UActorComponent interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// ~end UActorComponent interface
+
+	/** Captures the owner's current state into the frame buffer */
+	void RecordFrame();
+
+	/** Encodes the buffered frames and queues them for writing */
+	void FlushChunk();
+
+private:
+
+	/** Frames waiting to be encoded. Preallocated to a full chunk */
+	TArray<FSkateGhostQuantizedFrame> PendingFrames;
+
+	/** Open run file, shared with the write tasks */
+	TSharedPtr<FSkateGhostFileWriter> GhostWriter;
+
+	/** Serializes the file writes in order, off the game thread */
+	UE::Tasks::FPipe WritePipe{ TEXT("SkateGhostWriter") };
+
+	/** Name of the current or last run */
+	FString RunName;
+
+	/** Time left until the next frame is recorded */
+	float TimeUntilNextFrame = 0.0f;
+};
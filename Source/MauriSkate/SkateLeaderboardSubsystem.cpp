@@ -0,0 +1,336 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SkateLeaderboardSubsystem.h"
+#include "MauriSkate.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace SkateLeaderboard
+{
+	constexpr uint32 IndexMagic = 0x42544B53; // "SKTB"
+	constexpr uint32 IndexVersion = 1;
+	constexpr uint32 LogVersion = 1;
+
+	/** Index file header */
+	struct FIndexHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 Count;
+		uint32 Capacity;
+	};
+
+	/** One fixed size index entry */
+	struct FIndexEntry
+	{
+		int32 Score;
+		float Time;
+		int32 ObstaclesCleared;
+		uint32 Reserved;
+		int64 FinishedAtTicks;
+		UTF8CHAR GhostRunName[40];
+	};
+
+	static_assert(sizeof(FIndexHeader) == 16, "The index header is read straight from disk");
+	static_assert(sizeof(FIndexEntry) == 64, "Index entries are read straight from disk");
+
+	/** Sorts best first and drops what doesn't fit */
+	void KeepBest(TArray<FSkateRunRecord>& Runs, int32 Count)
+	{
+		Runs.StableSort([](const FSkateRunRecord& A, const FSkateRunRecord& B) { return A.RanksAbove(B); });
+
+		if (Runs.Num() > Count)
+		{
+			Runs.SetNum(Count);
+		}
+	}
+}
+
+void USkateLeaderboardSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// a log left big by the last session gets compacted in the background
+	IOPipe.Launch(UE_SOURCE_LOCATION, []()
+	{
+		if (IFileManager::Get().FileSize(*GetRunLogPath()) > CompactionThreshold)
+		{
+			CompactRunLog();
+		}
+	});
+}
+
+void USkateLeaderboardSubsystem::Deinitialize()
+{
+	// don't lose runs submitted right before quitting
+	IOPipe.WaitUntilEmpty();
+
+	Super::Deinitialize();
+}
+
+FString USkateLeaderboardSubsystem::GetLeaderboardDir()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Leaderboard"));
+}
+
+FString USkateLeaderboardSubsystem::GetRunLogPath()
+{
+	return FPaths::Combine(GetLeaderboardDir(), TEXT("Runs.log"));
+}
+
+FString USkateLeaderboardSubsystem::GetTopRunsPath(const FString& Level)
+{
+	return FPaths::Combine(GetLeaderboardDir(), FPaths::MakeValidFileName(Level) + TEXT(".top"));
+}
+
+int32 USkateLeaderboardSubsystem::SubmitRun(const FSkateRunRecord& Run)
+{
+	// append to the log
+	TArray<uint8> RunBytes;
+	{
+		FMemoryWriter Writer(RunBytes);
+		FSkateRunRecord MutableRun = Run;
+		SerializeRun(Writer, MutableRun);
+	}
+
+	IOPipe.Launch(UE_SOURCE_LOCATION, [RunBytes = MoveTemp(RunBytes)]()
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		PlatformFile.CreateDirectoryTree(*GetLeaderboardDir());
+
+		TUniquePtr<IFileHandle> Log(PlatformFile.OpenWrite(*GetRunLogPath(), true));
+		if (!Log)
+		{
+			UE_LOG(LogMauriSkate, Warning, TEXT("Couldn't open the run log %s"), *GetRunLogPath());
+			return;
+		}
+
+		// each record carries its size, so the log can be walked without knowing the format
+		uint32 Size = RunBytes.Num();
+		Log->Write(reinterpret_cast<const uint8*>(&Size), sizeof(Size));
+		Log->Write(RunBytes.GetData(), RunBytes.Num());
+
+		const int64 LogSize = Log->Size();
+		Log.Reset();
+
+		if (LogSize > CompactionThreshold)
+		{
+			CompactRunLog();
+		}
+	});
+
+	// update the level's top runs
+	TArray<FSkateRunRecord> Runs = FindOrLoadTopRuns(Run.Level);
+
+	const int32 Rank = Runs.IndexOfByPredicate([&Run](const FSkateRunRecord& Other) { return Run.RanksAbove(Other); });
+	const int32 InsertAt = Rank == INDEX_NONE ? Runs.Num() : Rank;
+	if (InsertAt >= TopRunsPerLevel)
+	{
+		return INDEX_NONE;
+	}
+
+	Runs.Insert(Run, InsertAt);
+	SkateLeaderboard::KeepBest(Runs, TopRunsPerLevel);
+
+	TArray<uint8> IndexBytes;
+	WriteTopRuns(Run.Level, Runs, IndexBytes);
+	TopRuns.Add(Run.Level, MoveTemp(Runs));
+
+	// write to the side and swap, so a reader never sees half an index
+	IOPipe.Launch(UE_SOURCE_LOCATION, [Path = GetTopRunsPath(Run.Level), IndexBytes = MoveTemp(IndexBytes)]()
+	{
+		const FString TempPath = Path + TEXT(".tmp");
+		if (FFileHelper::SaveArrayToFile(IndexBytes, *TempPath))
+		{
+			IFileManager::Get().Move(*Path, *TempPath, true);
+		}
+	});
+
+	return InsertAt;
+}
+
+TArray<FSkateRunRecord> USkateLeaderboardSubsystem::GetTopRuns(const FString& Level)
+{
+	return FindOrLoadTopRuns(Level);
+}
+
+TArray<FSkateRunRecord>& USkateLeaderboardSubsystem::FindOrLoadTopRuns(const FString& Level)
+{
+	if (TArray<FSkateRunRecord>* Runs = TopRuns.Find(Level))
+	{
+		return *Runs;
+	}
+
+	TArray<FSkateRunRecord>& Runs = TopRuns.Add(Level);
+	ReadTopRuns(Level, Runs);
+
+	return Runs;
+}
+
+bool USkateLeaderboardSubsystem::ReadTopRuns(const FString& Level, TArray<FSkateRunRecord>& OutRuns)
+{
+	using namespace SkateLeaderboard;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*GetTopRunsPath(Level)));
+	if (!MappedFile || MappedFile->GetFileSize() < static_cast<int64>(sizeof(FIndexHeader)))
+	{
+		return false;
+	}
+
+	// declared after the file so it's unmapped first
+	TUniquePtr<IMappedFileRegion> Region(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	if (!Region)
+	{
+		return false;
+	}
+
+	const uint8* Data = Region->GetMappedPtr();
+
+	FIndexHeader Header;
+	FMemory::Memcpy(&Header, Data, sizeof(Header));
+	if (Header.Magic != IndexMagic || Header.Version != IndexVersion)
+	{
+		return false;
+	}
+
+	const int64 EntriesInFile = (Region->GetMappedSize() - static_cast<int64>(sizeof(FIndexHeader))) / static_cast<int64>(sizeof(FIndexEntry));
+	const int32 Count = static_cast<int32>(FMath::Min3<int64>(Header.Count, EntriesInFile, TopRunsPerLevel));
+
+	OutRuns.Reset(Count);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		FIndexEntry Entry;
+		FMemory::Memcpy(&Entry, Data + sizeof(FIndexHeader) + Index * sizeof(FIndexEntry), sizeof(Entry));
+
+		FSkateRunRecord& Run = OutRuns.AddDefaulted_GetRef();
+		Run.Level = Level;
+		Run.Score = Entry.Score;
+		Run.Time = Entry.Time;
+		Run.ObstaclesCleared = Entry.ObstaclesCleared;
+		Run.FinishedAt = FDateTime(Entry.FinishedAtTicks);
+
+		int32 NameLength = 0;
+		while (NameLength < UE_ARRAY_COUNT(Entry.GhostRunName) && Entry.GhostRunName[NameLength] != 0)
+		{
+			++NameLength;
+		}
+		Run.GhostRunName = FString(NameLength, Entry.GhostRunName);
+	}
+
+	return true;
+}
+
+void USkateLeaderboardSubsystem::WriteTopRuns(const FString& Level, const TArray<FSkateRunRecord>& Runs, TArray<uint8>& OutBytes)
+{
+	using namespace SkateLeaderboard;
+
+	const int32 Count = FMath::Min(Runs.Num(), TopRunsPerLevel);
+
+	FIndexHeader Header;
+	Header.Magic = IndexMagic;
+	Header.Version = IndexVersion;
+	Header.Count = Count;
+	Header.Capacity = TopRunsPerLevel;
+
+	// always the full capacity, so the file never changes size
+	OutBytes.SetNumZeroed(sizeof(FIndexHeader) + TopRunsPerLevel * sizeof(FIndexEntry));
+	FMemory::Memcpy(OutBytes.GetData(), &Header, sizeof(Header));
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FSkateRunRecord& Run = Runs[Index];
+
+		FIndexEntry Entry;
+		FMemory::Memzero(Entry);
+		Entry.Score = Run.Score;
+		Entry.Time = Run.Time;
+		Entry.ObstaclesCleared = Run.ObstaclesCleared;
+		Entry.FinishedAtTicks = Run.FinishedAt.GetTicks();
+
+		// names longer than the slot are cut, leaving room for the terminator
+		const FTCHARToUTF8 GhostName(*Run.GhostRunName);
+		FMemory::Memcpy(Entry.GhostRunName, GhostName.Get(), FMath::Min<int32>(GhostName.Length(), UE_ARRAY_COUNT(Entry.GhostRunName) - 1));
+
+		FMemory::Memcpy(OutBytes.GetData() + sizeof(FIndexHeader) + Index * sizeof(FIndexEntry), &Entry, sizeof(Entry));
+	}
+}
+
+void USkateLeaderboardSubsystem::SerializeRun(FArchive& Ar, FSkateRunRecord& Run)
+{
+	uint8 Version = SkateLeaderboard::LogVersion;
+	Ar << Version;
+	Ar << Run.Level;
+	Ar << Run.Score;
+	Ar << Run.Time;
+	Ar << Run.ObstaclesCleared;
+	Ar << Run.FinishedAt;
+	Ar << Run.GhostRunName;
+}
+
+void USkateLeaderboardSubsystem::CompactRunLog()
+{
+	const FString LogPath = GetRunLogPath();
+
+	TArray<uint8> LogBytes;
+	if (!FFileHelper::LoadFileToArray(LogBytes, *LogPath, FILEREAD_Silent))
+	{
+		return;
+	}
+
+	// walk the log, a torn record at the end is dropped
+	TMap<FString, TArray<FSkateRunRecord>> RunsPerLevel;
+	int64 Offset = 0;
+	while (Offset + static_cast<int64>(sizeof(uint32)) <= LogBytes.Num())
+	{
+		uint32 Size;
+		FMemory::Memcpy(&Size, LogBytes.GetData() + Offset, sizeof(Size));
+		Offset += sizeof(Size);
+
+		if (Offset + Size > LogBytes.Num())
+		{
+			break;
+		}
+
+		TArray<uint8> RecordBytes(LogBytes.GetData() + Offset, Size);
+		FMemoryReader Reader(RecordBytes);
+		FSkateRunRecord Run;
+		SerializeRun(Reader, Run);
+		Offset += Size;
+
+		if (!Reader.IsError())
+		{
+			RunsPerLevel.FindOrAdd(Run.Level).Add(MoveTemp(Run));
+		}
+	}
+
+	TArray<uint8> CompactedBytes;
+	for (TPair<FString, TArray<FSkateRunRecord>>& Level : RunsPerLevel)
+	{
+		SkateLeaderboard::KeepBest(Level.Value, LoggedRunsPerLevel);
+
+		for (FSkateRunRecord& Run : Level.Value)
+		{
+			TArray<uint8> RunBytes;
+			FMemoryWriter Writer(RunBytes);
+			SerializeRun(Writer, Run);
+
+			const uint32 Size = RunBytes.Num();
+			CompactedBytes.Append(reinterpret_cast<const uint8*>(&Size), sizeof(Size));
+			CompactedBytes.Append(RunBytes);
+		}
+	}
+
+	const FString TempPath = LogPath + TEXT(".tmp");
+	if (FFileHelper::SaveArrayToFile(CompactedBytes, *TempPath))
+	{
+		IFileManager::Get().Move(*LogPath, *TempPath, true);
+		UE_LOG(LogMauriSkate, Log, TEXT("Compacted the run log from %d to %d bytes"), LogBytes.Num(), CompactedBytes.Num());
+	}
+}
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tasks/Pipe.h"
+#include "SkateLeaderboardSubsystem.generated.h"
+
+/** A finished skate run */
+USTRUCT(BlueprintType)
+struct FSkateRunRecord
+{
+	GENERATED_BODY()
+
+	/** Level the run was skated on */
+	UPROPERTY(BlueprintReadOnly, Category="Leaderboard")
+	FString Level;
+
+	/** Final score */
+	UPROPERTY(BlueprintReadOnly, Category="Leaderboard")
+	int32 Score = 0;
+
+	/** Run length, in seconds */
+	UPROPERTY(BlueprintReadOnly, Category="Leaderboard")
+	float Time = 0.0f;
+
+	/** Obstacles cleared during the run */
+	UPROPERTY(BlueprintReadOnly, Category="Leaderboard")
+	int32 ObstaclesCleared = 0;
+
+	/** When the run finished */
+	UPROPERTY(BlueprintReadOnly, Category="Leaderboard")
+	FDateTime FinishedAt;
+
+	/** Ghost run recorded alongside, if any. See USkateGhostRecorderComponent */
+	UPROPERTY(BlueprintReadOnly, Category="Leaderboard")
+	FString GhostRunName;
+
+	/** Returns true if this run ranks above the other one */
+	bool RanksAbove(const FSkateRunRecord& Other) const
+	{
+		return Score != Other.Score ? Score > Other.Score : Time < Other.Time;
+	}
+};
+
+/**
+ *  Local skate leaderboard.
+ *  Every finished run is appended to a binary run log. Each level also gets a small fixed size index of its best runs,
+ *  read through a memory mapping, so showing high scores costs the same however long the log gets.
+ *  All disk writes and the log compaction run in order on a background pipe.
+ */
+UCLASS()
+class MAURISKATE_API USkateLeaderboardSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Runs kept in each level's index */
+	static constexpr int32 TopRunsPerLevel = 10;
+
+	/** Runs per level the log keeps after compaction */
+	static constexpr int32 LoggedRunsPerLevel = 100;
+
+	/** Log size that triggers a compaction */
+	static constexpr int64 CompactionThreshold = 1024 * 1024;
+
+	/** Records a finished run. Returns its rank in the level's top runs, or INDEX_NONE if it didn't make it */
+	UFUNCTION(BlueprintCallable, Category="Leaderboard")
+	int32 SubmitRun(const FSkateRunRecord& Run);
+
+	/** Returns the best runs for a level, best first */
+	UFUNCTION(BlueprintCallable, Category="Leaderboard")
+	TArray<FSkateRunRecord> GetTopRuns(const FString& Level);
+
+	// ~begin USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// ~end USubsystem interface
+
+protected:
+
+	/** Returns the cached top runs for a level, reading its index the first time */
+	TArray<FSkateRunRecord>& FindOrLoadTopRuns(const FString& Level);
+
+	/** Returns the folder the leaderboard files live in */
+	static FString GetLeaderboardDir();
+
+	/** Returns the run log path */
+	static FString GetRunLogPath();
+
+	/** Returns the top runs index path for a level */
+	static FString GetTopRunsPath(const FString& Level);
+
+	/** Reads a level's index through a file mapping. Returns false if there's no valid index */
+	static bool ReadTopRuns(const FString& Level, TArray<FSkateRunRecord>& OutRuns);
+
+	/** Serializes a level's top runs into the fixed size index layout */
+	static void WriteTopRuns(const FString& Level, const TArray<FSkateRunRecord>& Runs, TArray<uint8>& OutBytes);
+
+	/** Appends or reads one run in the log format */
+	static void SerializeRun(FArchive& Ar, FSkateRunRecord& Run);
+
+	/** Rewrites the log keeping only the best runs of each level. Runs on the IO pipe */
+	static void CompactRunLog();
+
+private:
+
+	/** Top runs per level, loaded on first use */
+	TMap<FString, TArray<FSkateRunRecord>> TopRuns;
+
+	/** Serializes every disk access, off the game thread */
+	UE::Tasks::FPipe IOPipe{ TEXT("SkateLeaderboardIO") };
+};
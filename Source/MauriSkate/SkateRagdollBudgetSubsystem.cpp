@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SkateRagdollBudgetSubsystem.h"
+#include "MauriSkateCharacter.h"
+
+void USkateRagdollBudgetSubsystem::AcquireRagdoll(AMauriSkateCharacter* Skater)
+{
+	if (!Skater || Ragdolls.ContainsByPredicate([Skater](const FRagdollEntry& Entry) { return Entry.Skater == Skater; }))
+	{
+		return;
+	}
+
+	FRagdollEntry& Entry = Ragdolls.AddDefaulted_GetRef();
+	Entry.Skater = Skater;
+
+	EnforceBudget();
+}
+
+void USkateRagdollBudgetSubsystem::ReleaseRagdoll(AMauriSkateCharacter* Skater)
+{
+	Ragdolls.RemoveAll([Skater](const FRagdollEntry& Entry) { return Entry.Skater == Skater; });
+}
+
+int32 USkateRagdollBudgetSubsystem::GetNumSimulatingRagdolls() const
+{
+	int32 NumSimulating = 0;
+	for (const FRagdollEntry& Entry : Ragdolls)
+	{
+		NumSimulating += Entry.bSleeping ? 0 : 1;
+	}
+
+	return NumSimulating;
+}
+
+void USkateRagdollBudgetSubsystem::Tick(float DeltaTime)
+{
+	// forget skaters that went away mid crash
+	Ragdolls.RemoveAll([](const FRagdollEntry& Entry) { return !Entry.Skater.IsValid(); });
+
+	// anything touching a sleeping ragdoll wakes it, and then it counts again
+	for (FRagdollEntry& Entry : Ragdolls)
+	{
+		if (Entry.bSleeping && Entry.Skater->IsRagdollAwake())
+		{
+			Entry.bSleeping = false;
+		}
+	}
+
+	EnforceBudget();
+}
+
+void USkateRagdollBudgetSubsystem::EnforceBudget()
+{
+	int32 NumSimulating = GetNumSimulatingRagdolls();
+
+	for (FRagdollEntry& Entry : Ragdolls)
+	{
+		if (NumSimulating <= MaxSimulatingRagdolls)
+		{
+			break;
+		}
+
+		AMauriSkateCharacter* Skater = Entry.Skater.Get();
+		if (!Entry.bSleeping && Skater)
+		{
+			// a sleeping ragdoll costs nothing until something hits it
+			Skater->SleepRagdoll();
+			Entry.bSleeping = true;
+			--NumSimulating;
+		}
+	}
+}
+
+TStatId USkateRagdollBudgetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USkateRagdollBudgetSubsystem, STATGROUP_Tickables);
+}
+
+bool USkateRagdollBudgetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SkateRagdollBudgetSubsystem.generated.h"
+
+class AMauriSkateCharacter;
+
+/**
+ *  Caps how many crashed skaters simulate their ragdoll at once.
+ *  Past the budget, the oldest awake ragdolls are put to sleep so the physics cost stays bounded however many skaters crash.
+ *  Ragdolls stay counted until they leave ragdoll entirely, including while blending back to the animation, and sleeping
+ *  ones are checked every frame, since any contact wakes them up again.
+ */
+UCLASS()
+class MAURISKATE_API USkateRagdollBudgetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Ragdolls allowed to simulate at the same time */
+	static constexpr int32 MaxSimulatingRagdolls = 4;
+
+	/** Adds a skater that just started simulating. May put the oldest ragdoll to sleep */
+	void AcquireRagdoll(AMauriSkateCharacter* Skater);
+
+	/** Removes a skater that left ragdoll */
+	void ReleaseRagdoll(AMauriSkateCharacter* Skater);
+
+	/** Returns the number of ragdolls currently simulating */
+	int32 GetNumSimulatingRagdolls() const;
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	// ~begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// ~end UWorldSubsystem interface
+
+private:
+
+	/** A skater in ragdoll */
+	struct FRagdollEntry
+	{
+		TWeakObjectPtr<AMauriSkateCharacter> Skater;
+
+		/** True while we have it asleep */
+		bool bSleeping = false;
+	};
+
+	/** Puts the oldest awake ragdolls to sleep until the budget is met */
+	void EnforceBudget();
+
+	/** Skaters in ragdoll, oldest first */
+	TArray<FRagdollEntry, TInlineAllocator<MaxSimulatingRagdolls * 2>> Ragdolls;
+};
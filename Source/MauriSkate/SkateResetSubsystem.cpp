@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SkateResetSubsystem.h"
+#include "MauriSkate.h"
+#include "SkateTelemetry.h"
+
+DECLARE_CYCLE_STAT(TEXT("World Reset"), STAT_SkateWorldReset, STATGROUP_Skate);
+
+void USkateResetSubsystem::RegisterResettable(TScriptInterface<ISkateResettable> Resettable)
+{
+	const TWeakInterfacePtr<ISkateResettable> WeakResettable(Resettable.GetObject());
+	if (!WeakResettable.IsValid() || Resettables.Contains(WeakResettable))
+	{
+		return;
+	}
+
+	WeakResettable->CaptureResetState();
+	Resettables.Add(WeakResettable);
+}
+
+void USkateResetSubsystem::UnregisterResettable(TScriptInterface<ISkateResettable> Resettable)
+{
+	Resettables.Remove(TWeakInterfacePtr<ISkateResettable>(Resettable.GetObject()));
+}
+
+void USkateResetSubsystem::ResetWorld()
+{
+	SCOPE_CYCLE_COUNTER(STAT_SkateWorldReset);
+
+	// forget objects that went away without unregistering
+	Resettables.RemoveAll([](const TWeakInterfacePtr<ISkateResettable>& Resettable) { return !Resettable.IsValid(); });
+
+	for (const TWeakInterfacePtr<ISkateResettable>& Resettable : Resettables)
+	{
+		Resettable->RestoreResetState();
+	}
+
+	UE_LOG(LogMauriSkate, Verbose, TEXT("Reset %d objects in place"), Resettables.Num());
+
+	OnWorldReset.Broadcast();
+}
+
+bool USkateResetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "UObject/WeakInterfacePtr.h"
+#include "SkateResetSubsystem.generated.h"
+
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
+class USkateResettable : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ *  Something the USkateResetSubsystem can put back the way it was when play started.
+ *  Implementers keep their own snapshot, so resetting never allocates.
+ */
+class MAURISKATE_API ISkateResettable
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Stores the state to come back to. Called once when registering */
+	virtual void CaptureResetState() = 0;
+
+	/** Goes back to the captured state */
+	virtual void RestoreResetState() = 0;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnSkateWorldReset);
+
+/**
+ *  Resets a level in place for fast retries.
+ *  Skaters, obstacles and points register at BeginPlay, capturing their starting state.
+ *  A reset restores every snapshot on the same frame, without reloading the map or re-creating actors.
+ */
+UCLASS()
+class MAURISKATE_API USkateResetSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Broadcast after every registered object has been restored */
+	UPROPERTY(BlueprintAssignable, Category="Skate")
+	FOnSkateWorldReset OnWorldReset;
+
+	/** Captures the object's state and restores it on every reset */
+	void RegisterResettable(TScriptInterface<ISkateResettable> Resettable);
+
+	/** Stops restoring the object */
+	void UnregisterResettable(TScriptInterface<ISkateResettable> Resettable);
+
+	/** Restores every registered object to its starting state */
+	UFUNCTION(BlueprintCallable, Category="Skate")
+	void ResetWorld();
+
+protected:
+
+	// ~begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// ~end UWorldSubsystem interface
+
+private:
+
+	/** Registered objects, in registration order */
+	TArray<TWeakInterfacePtr<ISkateResettable>> Resettables;
+};
@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SkateSimulation.h"
+
+FSkateFrictionTable::FSkateFrictionTable()
+{
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		Rolling[Index] = 1.0f;
+		SlowDown[Index] = 1.0f;
+	}
+}
+
+void FSkateFrictionTable::Bake(float InMaxSpeed, TFunctionRef<float(float)> RollingCurve, TFunctionRef<float(float)> SlowDownCurve)
+{
+	MaxSpeed = FMath::Max(InMaxSpeed, 1.0f);
+	SpeedToSample = (NumSamples - 1) / MaxSpeed;
+
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		const float Speed = Index / SpeedToSample;
+		Rolling[Index] = FMath::Max(0.0f, RollingCurve(Speed));
+		SlowDown[Index] = FMath::Max(0.0f, SlowDownCurve(Speed));
+	}
+}
+
+float FSkateSimState::GetPushPhase(const FSkateSimParams& Params) const
+{
+	if (!IsPushing() || Params.PushDuration <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	return FMath::Clamp(1.0f - (PushRemainingTime / Params.PushDuration), 0.0f, 1.0f);
+}
+
+FSkateSimState FSkateSimState::Interpolate(const FSkateSimState& A, const FSkateSimState& B, float Alpha)
+{
+	FSkateSimState Result = B;
+	Result.Location = FMath::Lerp(A.Location, B.Location, Alpha);
+	Result.Velocity = FMath::Lerp(A.Velocity, B.Velocity, Alpha);
+
+	// lerp the rotators so we take the shortest path around
+	Result.Yaw = FMath::Lerp(FRotator(0.0f, A.Yaw, 0.0f), FRotator(0.0f, B.Yaw, 0.0f), Alpha).Yaw;
+
+	return Result;
+}
+
+FSkateSimStepResult FSkateSimStep::Advance(FSkateSimState& State, const FSkateSimInput& Input, const FSkateSimParams& Params)
+{
+	FSkateSimStepResult Result;
+	const float DeltaTime = Params.FixedStep;
+
+	State.bIsSlowingDown = Input.bSlowingDown;
+
+	// start a new push if we're free to
+	if (Input.bPushRequested && !State.IsPushing() && Input.bGrounded)
+	{
+		State.PushRemainingTime = Params.PushDuration;
+		Result.bPushStarted = true;
+	}
+
+	// advance the push animation
+	State.PushRemainingTime = FMath::Max(State.PushRemainingTime - DeltaTime, 0.0f);
+
+	float PushFactor = Input.PushImpulseFactor;
+
+	if (State.IsPushing() &&
+		!State.bPushingInstantReached &&
+		State.PushRemainingTime <= (1.0f - Params.PushInstantNormalized) * Params.PushDuration)
+	{
+		// the foot reached the floor, apply the impulse in sync with the animation
+		PushFactor += 1.0f;
+		State.bPushingInstantReached = true;
+		Result.bPushImpulseApplied = true;
+	}
+	else if (!Input.bGrounded && State.IsPushing())
+	{
+		// cancels pushing if we start to be in the air
+		State.PushRemainingTime = 0.0f;
+		Result.bPushCancelled = true;
+	}
+
+	if (!State.IsPushing())
+	{
+		State.bPushingInstantReached = false;
+	}
+
+	if (Input.bGrounded)
+	{
+		FRotator Rotation(0.0f, State.Yaw, 0.0f);
+		const FVector BoardForward = FRotationMatrix(Rotation).GetUnitAxis(EAxis::X);
+
+		// push impulses
+		State.Velocity += BoardForward * (PushFactor * Params.PushVelocityChange);
+
+		// ramp gravity
+		State.Velocity += ComputeRampAcceleration(BoardForward, Input.FloorNormal, Params) * DeltaTime;
+
+		// friction. Same model as the character movement braking with no braking deceleration
+		const float SurfaceFriction = Input.FrictionTable ? Input.FrictionTable->Evaluate(State.Velocity.Size2D(), State.bIsSlowingDown) : 1.0f;
+		const float Friction = (State.bIsSlowingDown ? Params.SlowDownFriction : Params.FloorFriction) * SurfaceFriction * FMath::Max(0.0f, Params.BrakingFrictionFactor);
+		State.Velocity *= FMath::Max(0.0f, 1.0f - FMath::Max(0.0f, Friction) * DeltaTime);
+
+		// ground movement is horizontal, the floor projection happens when moving
+		FVector HorizontalVelocity(State.Velocity.X, State.Velocity.Y, 0.0f);
+
+		// turning redirects the horizontal speed into the new facing
+		if (Input.bHasTurnTarget)
+		{
+			// RInterpConstantTo uses Degrees
+			Rotation = FMath::RInterpConstantTo(Rotation, FRotator(0.0f, Input.TurnTargetYaw, 0.0f), DeltaTime, Params.TurnRate);
+
+			// keep rolling backwards if we were already doing so
+			const float Direction = (HorizontalVelocity | BoardForward) < 0.0f ? -1.0f : 1.0f;
+			HorizontalVelocity = FRotationMatrix(Rotation).GetUnitAxis(EAxis::X) * (HorizontalVelocity.Size() * Direction);
+			State.Yaw = FRotator::NormalizeAxis(Rotation.Yaw);
+		}
+
+		// cap the horizontal speed
+		State.Velocity = HorizontalVelocity.GetClampedToMaxSize(Params.MaxHorizontalSpeed * Input.MaxSpeedScale);
+	}
+	else
+	{
+		State.Velocity.Z += Params.GravityZ * DeltaTime;
+	}
+
+	State.Location += State.Velocity * DeltaTime;
+
+	return Result;
+}
+
+FVector FSkateSimStep::ComputeRampAcceleration(const FVector& BoardForward, const FVector& FloorNormal, const FSkateSimParams& Params)
+{
+	// flat enough to ignore
+	if (FloorNormal.Dot(FVector::UpVector) >= 0.98)
+	{
+		return FVector::ZeroVector;
+	}
+
+	// the board only slides along its own facing, so a board perpendicular to the ramp stays put
+	const FVector Ramp = (FloorNormal * FVector(1.0, 1.0, 0.0)).GetSafeNormal(0.001);
+	const FVector DownsideFacing = (Ramp.Dot(BoardForward) > Ramp.Dot(-BoardForward)) ? BoardForward : -BoardForward;
+
+	const FVector Inclination = FVector::VectorPlaneProject(DownsideFacing, FloorNormal).GetSafeNormal(0.001);
+	return Inclination * (Inclination.Dot(FVector::DownVector) * -Params.GravityZ * Params.GravityFactor);
+}
+
+int32 FSkateSimAccumulator::Consume(float DeltaTime, const FSkateSimParams& Params)
+{
+	if (Params.FixedStep <= 0.0f)
+	{
+		return 0;
+	}
+
+	Accumulator += DeltaTime;
+
+	int32 Steps = FMath::FloorToInt32(Accumulator / Params.FixedStep);
+
+	// drop the backlog after a long hitch instead of spiralling
+	if (Steps > Params.MaxStepsPerFrame)
+	{
+		Steps = Params.MaxStepsPerFrame;
+		Accumulator = Steps * static_cast<double>(Params.FixedStep);
+	}
+
+	Accumulator -= Steps * static_cast<double>(Params.FixedStep);
+
+	return Steps;
+}
+
+float FSkateSimAccumulator::GetAlpha(const FSkateSimParams& Params) const
+{
+	return Params.FixedStep > 0.0f ? FMath::Clamp(static_cast<float>(Accumulator / Params.FixedStep), 0.0f, 1.0f) : 1.0f;
+}
@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ *  Fixed timestep skate simulation core.
+ *  Plain C++ with no actor or component dependencies, so it gives the same results at any frame rate
+ *  and can be run headless. UMauriSkateMovementComponent drives it and resolves collision on top.
+ */
+
+/** Skate tuning, gathered from the skate character once per frame */
+struct MAURISKATE_API FSkateSimParams
+{
+	/** Length of one simulation step, in seconds */
+	float FixedStep = 1.0f / 120.0f;
+
+	/** Max number of steps run in a single frame. Any backlog beyond this is dropped */
+	int32 MaxStepsPerFrame = 8;
+
+	/** Full length of the push animation */
+	float PushDuration = 2.0f;
+
+	/** Normalized time in the push animation at which the foot hits the floor */
+	float PushInstantNormalized = 0.5769f;
+
+	/** Velocity change applied by a full push */
+	float PushVelocityChange = 500.0f;
+
+	/** Horizontal speed cap */
+	float MaxHorizontalSpeed = 1000.0f;
+
+	/** Turn rate, in degrees per second */
+	float TurnRate = 360.0f;
+
+	/** Multiplier for the ramp gravity */
+	float GravityFactor = 1.0f;
+
+	/** World gravity */
+	float GravityZ = -980.0f;
+
+	/** Friction while rolling */
+	float FloorFriction = 0.08f;
+
+	/** Friction while slowing down */
+	float SlowDownFriction = 4.0f;
+
+	/** Multiplier applied to both frictions, same as the character movement braking */
+	float BrakingFrictionFactor = 2.0f;
+};
+
+/** Speed dependent friction multipliers, baked from curves into small fixed size tables so a lookup is a clamp, an index and a lerp */
+struct MAURISKATE_API FSkateFrictionTable
+{
+	/** Samples per table, spread evenly from zero to MaxSpeed */
+	static constexpr int32 NumSamples = 32;
+
+	/** Speed of the last sample. Faster speeds use the last sample */
+	float MaxSpeed = 1.0f;
+
+	/** Multiplier turning a speed into a sample position */
+	float SpeedToSample = 0.0f;
+
+	/** Multiplier for the rolling friction */
+	float Rolling[NumSamples];
+
+	/** Multiplier for the slow down friction */
+	float SlowDown[NumSamples];
+
+	/** Builds a flat table, where friction doesn't depend on speed */
+	FSkateFrictionTable();
+
+	/** Samples both curves, as functions of the speed */
+	void Bake(float InMaxSpeed, TFunctionRef<float(float)> RollingCurve, TFunctionRef<float(float)> SlowDownCurve);
+
+	/** Returns the friction multiplier at the provided speed */
+	float Evaluate(float Speed, bool bSlowingDown) const
+	{
+		const float Position = FMath::Clamp(Speed * SpeedToSample, 0.0f, static_cast<float>(NumSamples - 1));
+		const int32 Index = FMath::Min(static_cast<int32>(Position), NumSamples - 2);
+		const float* Samples = bSlowingDown ? SlowDown : Rolling;
+
+		return FMath::Lerp(Samples[Index], Samples[Index + 1], Position - Index);
+	}
+};
+
+/** Input for a single simulation step */
+struct MAURISKATE_API FSkateSimInput
+{
+	/** Starts a push if the skate is grounded and not pushing already */
+	bool bPushRequested = false;
+
+	/** Extra push impulse requested from gameplay code, as a fraction of a full push */
+	float PushImpulseFactor = 0.0f;
+
+	/** Selects the slow down friction */
+	bool bSlowingDown = false;
+
+	/** If true, the board turns towards TurnTargetYaw */
+	bool bHasTurnTarget = false;
+
+	/** Yaw the board is turning towards, in degrees */
+	float TurnTargetYaw = 0.0f;
+
+	/** True while the board is on a walkable floor */
+	bool bGrounded = true;
+
+	/** Normal of the floor under the board */
+	FVector FloorNormal = FVector::UpVector;
+
+	/** Friction multipliers of the floor under the board. Friction doesn't depend on speed if null */
+	const FSkateFrictionTable* FrictionTable = nullptr;
+
+	/** Multiplier for the horizontal speed cap on the floor under the board */
+	float MaxSpeedScale = 1.0f;
+};
+
+/** Skate state advanced by the simulation */
+struct MAURISKATE_API FSkateSimState
+{
+	/** Board location. Collision-free; the movement component overwrites it with the swept result */
+	FVector Location = FVector::ZeroVector;
+
+	/** Board velocity */
+	FVector Velocity = FVector::ZeroVector;
+
+	/** Board facing, in degrees */
+	float Yaw = 0.0f;
+
+	/** Time left in the current push animation */
+	float PushRemainingTime = 0.0f;
+
+	/** True once the current push has applied its impulse */
+	bool bPushingInstantReached = false;
+
+	/** True while the slow down friction is in use */
+	bool bIsSlowingDown = false;
+
+	/** Returns true while a push is playing */
+	bool IsPushing() const { return PushRemainingTime > 0.0f; }
+
+	/** Returns the normalized 0-1 progress of the current push */
+	float GetPushPhase(const FSkateSimParams& Params) const;
+
+	/** Blends two states for presentation. Discrete state comes from B */
+	static FSkateSimState Interpolate(const FSkateSimState& A, const FSkateSimState& B, float Alpha);
+};
+
+/** Events raised while advancing a single step */
+struct MAURISKATE_API FSkateSimStepResult
+{
+	/** A push animation started */
+	bool bPushStarted = false;
+
+	/** A push impulse was applied */
+	bool bPushImpulseApplied = false;
+
+	/** A push was cancelled by leaving the floor */
+	bool bPushCancelled = false;
+};
+
+/** Advances the skate state by one fixed step */
+struct MAURISKATE_API FSkateSimStep
+{
+	/** Runs one step of Params.FixedStep seconds */
+	static FSkateSimStepResult Advance(FSkateSimState& State, const FSkateSimInput& Input, const FSkateSimParams& Params);
+
+	/** Acceleration pulling the board down a ramp along its own facing */
+	static FVector ComputeRampAcceleration(const FVector& BoardForward, const FVector& FloorNormal, const FSkateSimParams& Params);
+};
+
+/** Turns variable frame times into a whole number of fixed steps */
+struct MAURISKATE_API FSkateSimAccumulator
+{
+	/** Time waiting to be simulated */
+	double Accumulator = 0.0;
+
+	/** Adds the frame time and returns how many fixed steps should run */
+	int32 Consume(float DeltaTime, const FSkateSimParams& Params);
+
+	/** Returns how far we are into the next step, for presentation interpolation */
+	float GetAlpha(const FSkateSimParams& Params) const;
+
+	/** Drops any pending time */
+	void Reset() { Accumulator = 0.0; }
+};
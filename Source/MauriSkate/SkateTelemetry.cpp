@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SkateTelemetry.h"
+#include "GameFramework/Actor.h"
+
+DEFINE_STAT(STAT_SkatePushes);
+DEFINE_STAT(STAT_SkateImpulses);
+DEFINE_STAT(STAT_SkateSlowDowns);
+DEFINE_STAT(STAT_SkateAwards);
+DEFINE_STAT(STAT_SkateDeaths);
+
+int32 FSkateMovementCounters::MoveSweeps = 0;
+int32 FSkateMovementCounters::FloorQueries = 0;
+uint64 FSkateMovementCounters::MovementCycles = 0;
+
+void FSkateMovementCounters::Reset()
+{
+	MoveSweeps = 0;
+	FloorQueries = 0;
+	MovementCycles = 0;
+}
+
+#if SKATE_TELEMETRY_ENABLED
+
+UE_TRACE_CHANNEL_DEFINE(SkateChannel);
+
+UE_TRACE_EVENT_BEGIN(Skate, Push)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, SkaterId)
+	UE_TRACE_EVENT_FIELD(float, Speed)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Skate, Impulse)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, SkaterId)
+	UE_TRACE_EVENT_FIELD(float, Factor)
+	UE_TRACE_EVENT_FIELD(float, Speed)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Skate, SlowDown)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, SkaterId)
+	UE_TRACE_EVENT_FIELD(bool, Started)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Skate, Award)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, RecipientId)
+	UE_TRACE_EVENT_FIELD(int32, Points)
+	UE_TRACE_EVENT_FIELD(int32, Total)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Skate, Death)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, SkaterId)
+	UE_TRACE_EVENT_FIELD(double, X)
+	UE_TRACE_EVENT_FIELD(double, Y)
+	UE_TRACE_EVENT_FIELD(double, Z)
+UE_TRACE_EVENT_END()
+
+void FSkateTelemetry::TracePush(const AActor* Skater, float Speed)
+{
+	UE_TRACE_LOG(Skate, Push, SkateChannel)
+		<< Push.Cycle(FPlatformTime::Cycles64())
+		<< Push.SkaterId(Skater ? Skater->GetUniqueID() : 0)
+		<< Push.Speed(Speed);
+}
+
+void FSkateTelemetry::TraceImpulse(const AActor* Skater, float Factor, float Speed)
+{
+	UE_TRACE_LOG(Skate, Impulse, SkateChannel)
+		<< Impulse.Cycle(FPlatformTime::Cycles64())
+		<< Impulse.SkaterId(Skater ? Skater->GetUniqueID() : 0)
+		<< Impulse.Factor(Factor)
+		<< Impulse.Speed(Speed);
+}
+
+void FSkateTelemetry::TraceSlowDown(const AActor* Skater, bool bStarted)
+{
+	UE_TRACE_LOG(Skate, SlowDown, SkateChannel)
+		<< SlowDown.Cycle(FPlatformTime::Cycles64())
+		<< SlowDown.SkaterId(Skater ? Skater->GetUniqueID() : 0)
+		<< SlowDown.Started(bStarted);
+}
+
+void FSkateTelemetry::TraceAward(const AActor* Recipient, int32 Points, int32 Total)
+{
+	UE_TRACE_LOG(Skate, Award, SkateChannel)
+		<< Award.Cycle(FPlatformTime::Cycles64())
+		<< Award.RecipientId(Recipient ? Recipient->GetUniqueID() : 0)
+		<< Award.Points(Points)
+		<< Award.Total(Total);
+}
+
+void FSkateTelemetry::TraceDeath(const AActor* Skater, const FVector& Location)
+{
+	UE_TRACE_LOG(Skate, Death, SkateChannel)
+		<< Death.Cycle(FPlatformTime::Cycles64())
+		<< Death.SkaterId(Skater ? Skater->GetUniqueID() : 0)
+		<< Death.X(Location.X)
+		<< Death.Y(Location.Y)
+		<< Death.Z(Location.Z);
+}
+
+#endif // SKATE_TELEMETRY_ENABLED
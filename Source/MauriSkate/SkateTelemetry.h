@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+class AActor;
+
+/** Skate telemetry is compiled out of shipping builds and builds without trace support */
+#define SKATE_TELEMETRY_ENABLED (UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+
+DECLARE_STATS_GROUP(TEXT("Skate"), STATGROUP_Skate, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pushes"), STAT_SkatePushes, STATGROUP_Skate, MAURISKATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Push Impulses"), STAT_SkateImpulses, STATGROUP_Skate, MAURISKATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Slow Downs"), STAT_SkateSlowDowns, STATGROUP_Skate, MAURISKATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Point Awards"), STAT_SkateAwards, STATGROUP_Skate, MAURISKATE_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Deaths"), STAT_SkateDeaths, STATGROUP_Skate, MAURISKATE_API);
+
+/**
+ *  Plain skate movement cost counters, readable without the stats system so headless benchmarks can sample them.
+ *  Game thread only. Whoever samples them resets them.
+ */
+struct MAURISKATE_API FSkateMovementCounters
+{
+	/** Updated component moves that swept */
+	static int32 MoveSweeps;
+
+	/** Floor queries. Each is a capsule sweep, sometimes followed by a line trace */
+	static int32 FloorQueries;
+
+	/** Time spent ticking skate movement components */
+	static uint64 MovementCycles;
+
+	/** Zeroes every counter */
+	static void Reset();
+};
+
+#if SKATE_TELEMETRY_ENABLED
+
+/** Insights channel for the skate events. Enable with -trace=Skate */
+UE_TRACE_CHANNEL_EXTERN(SkateChannel, MAURISKATE_API);
+
+/**
+ *  Typed skate trace events.
+ *  Only reached through the SKATE_TRACE_* macros, so calls vanish when telemetry is compiled out.
+ */
+struct MAURISKATE_API FSkateTelemetry
+{
+	/** A push animation started */
+	static void TracePush(const AActor* Skater, float Speed);
+
+	/** A push impulse was applied */
+	static void TraceImpulse(const AActor* Skater, float Factor, float Speed);
+
+	/** Slowing down started or stopped */
+	static void TraceSlowDown(const AActor* Skater, bool bStarted);
+
+	/** Points were awarded */
+	static void TraceAward(const AActor* Recipient, int32 Points, int32 Total);
+
+	/** A skater died */
+	static void TraceDeath(const AActor* Skater, const FVector& Location);
+};
+
+#define SKATE_TRACE_PUSH(Skater, Speed) \
+	do { INC_DWORD_STAT(STAT_SkatePushes); FSkateTelemetry::TracePush(Skater, Speed); } while (0)
+
+#define SKATE_TRACE_IMPULSE(Skater, Factor, Speed) \
+	do { INC_DWORD_STAT(STAT_SkateImpulses); FSkateTelemetry::TraceImpulse(Skater, Factor, Speed); } while (0)
+
+#define SKATE_TRACE_SLOW_DOWN(Skater, bStarted) \
+	do { INC_DWORD_STAT_BY(STAT_SkateSlowDowns, (bStarted) ? 1 : 0); FSkateTelemetry::TraceSlowDown(Skater, bStarted); } while (0)
+
+#define SKATE_TRACE_AWARD(Recipient, Points, Total) \
+	do { INC_DWORD_STAT(STAT_SkateAwards); FSkateTelemetry::TraceAward(Recipient, Points, Total); } while (0)
+
+#define SKATE_TRACE_DEATH(Skater, Location) \
+	do { INC_DWORD_STAT(STAT_SkateDeaths); FSkateTelemetry::TraceDeath(Skater, Location); } while (0)
+
+#else
+
+#define SKATE_TRACE_PUSH(Skater, Speed)
+#define SKATE_TRACE_IMPULSE(Skater, Factor, Speed)
+#define SKATE_TRACE_SLOW_DOWN(Skater, bStarted)
+#define SKATE_TRACE_AWARD(Recipient, Points, Total)
+#define SKATE_TRACE_DEATH(Skater, Location)
+
+#endif // SKATE_TELEMETRY_ENABLED
@@ -11,6 +11,9 @@
 #include "TimerManager.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Animation/AnimInstance.h"
+#include "CombatTraceSubsystem.h"
+#include "CombatDamageSubsystem.h"
+#include "CombatSignificanceSubsystem.h"
 
 ACombatEnemy::ACombatEnemy()
 {
@@ -113,47 +116,71 @@ void ACombatEnemy::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted)
 	OnAttackCompleted.ExecuteIfBound();
 }
 
-void ACombatEnemy::DoAttackTrace(FName DamageSourceBone)
+FCombatTraceRequest ACombatEnemy::MakeAttackTraceRequest(FName DamageSourceBone)
 {
-	// sweep for objects in front of the character to be hit by the attack
-	TArray<FHitResult> OutHits;
+	FCombatTraceRequest Request;
+	Request.Attacker = this;
 
 	// start at the provided socket location, sweep forward
-	const FVector TraceStart = GetMesh()->GetSocketLocation(DamageSourceBone);
-	const FVector TraceEnd = TraceStart + (GetActorForwardVector() * MeleeTraceDistance);
+	Request.Start = GetMesh()->GetSocketLocation(DamageSourceBone);
+	Request.End = Request.Start + (GetActorForwardVector() * MeleeTraceDistance);
+
+	// use a sphere shape for the sweep
+	Request.Radius = MeleeTraceRadius;
 
 	// enemies only affect Pawn collision objects; they don't knock back boxes
-	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	Request.ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
 
-	// use a sphere shape for the sweep
-	FCollisionShape CollisionShape;
-	CollisionShape.SetSphere(MeleeTraceRadius);
+	return Request;
+}
 
-	// ignore self
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
+void ACombatEnemy::DoAttackTrace(FName DamageSourceBone)
+{
+	// queue a sweep for objects in front of the character to be hit by the attack
+	// the hits come back through ResolveAttackHits on the next frame
+	if (UCombatTraceSubsystem* TraceSubsystem = GetWorld()->GetSubsystem<UCombatTraceSubsystem>())
+	{
+		TraceSubsystem->SubmitSweep(MakeAttackTraceRequest(DamageSourceBone));
+	}
+}
 
-	if (GetWorld()->SweepMultiByObjectType(OutHits, TraceStart, TraceEnd, FQuat::Identity, ObjectParams, CollisionShape, QueryParams))
+void ACombatEnemy::BeginAttackSwing(FName DamageSourceBone)
+{
+	// sweep the bone's path each frame until the swing ends
+	if (UCombatTraceSubsystem* TraceSubsystem = GetWorld()->GetSubsystem<UCombatTraceSubsystem>())
 	{
-		// iterate over each object hit
-		for (const FHitResult& CurrentHit : OutHits)
-		{
-			/** does the actor have the player tag? */
-			if (CurrentHit.GetActor()->ActorHasTag(FName("Player")))
-			{
-				// check if the actor is damageable
-				ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
+		TraceSubsystem->BeginSwing(MakeAttackTraceRequest(DamageSourceBone), GetMesh(), DamageSourceBone);
+	}
+}
 
-				if (Damageable)
-				{
-					// knock upwards and away from the impact normal
-					const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
+void ACombatEnemy::EndAttackSwing(FName DamageSourceBone)
+{
+	if (UCombatTraceSubsystem* TraceSubsystem = GetWorld()->GetSubsystem<UCombatTraceSubsystem>())
+	{
+		TraceSubsystem->EndSwing(this, DamageSourceBone);
+	}
+}
+
+void ACombatEnemy::ResolveAttackHits(const TArray<FHitResult>& Hits)
+{
+	// iterate over each object hit
+	for (const FHitResult& CurrentHit : Hits)
+	{
+		AActor* HitActor = CurrentHit.GetActor();
 
-					// pass the damage event to the actor
-					Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+		/** does the actor have the player tag? */
+		if (HitActor && HitActor->ActorHasTag(FName("Player")))
+		{
+			// check if the actor is damageable
+			ICombatDamageable* Damageable = Cast<ICombatDamageable>(HitActor);
+
+			if (Damageable)
+			{
+				// knock upwards and away from the impact normal
+				const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
 
-				}
+				// pass the damage event to the actor
+				Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
 			}
 		}
 	}
@@ -189,36 +216,60 @@ void ACombatEnemy::CheckChargedAttack()
 
 void ACombatEnemy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
 {
-	
+	// queue the damage, it's resolved next frame together with everything else that hit us
+	if (UCombatDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UCombatDamageSubsystem>())
+	{
+		DamageSubsystem->QueueDamage(this, Damage, DamageCauser, DamageLocation, DamageImpulse);
+	}
+}
+
+float ACombatEnemy::ResolveDamage(float Damage, AActor* DamageCauser)
+{
 	// pass the damage event to the actor
 	FDamageEvent DamageEvent;
 	const float ActualDamage = TakeDamage(Damage, DamageEvent, nullptr, DamageCauser);
 
-	// only process knockback and effects if we received nonzero damage
+	// stop the attack montages to interrupt the attack
 	if (ActualDamage > 0.0f)
 	{
-		// apply the knockback impulse
-		GetCharacterMovement()->AddImpulse(DamageImpulse, true);
-
-		// is the character ragdolling?
-		if (GetMesh()->IsSimulatingPhysics())
-		{
-			// apply an impulse to the ragdoll
-			GetMesh()->AddImpulseAtLocation(DamageImpulse * GetMesh()->GetMass(), DamageLocation);
-		}
-
-		// stop the attack montages to interrupt the attack
 		if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
 		{
 			AnimInstance->Montage_Stop(0.1f, ComboAttackMontage);
 			AnimInstance->Montage_Stop(0.1f, ChargedAttackMontage);
 		}
+	}
+
+	return ActualDamage;
+}
+
+void ACombatEnemy::ResolveDamageImpulse(const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	// apply the knockback impulse
+	GetCharacterMovement()->AddImpulse(DamageImpulse, true);
+
+	// is the character ragdolling?
+	if (GetMesh()->IsSimulatingPhysics())
+	{
+		// apply an impulse to the ragdoll
+		GetMesh()->AddImpulseAtLocation(DamageImpulse * GetMesh()->GetMass(), DamageLocation);
+	}
+}
 
-		// pass control to BP to play effects, etc.
-		ReceivedDamage(ActualDamage, DamageLocation, DamageImpulse.GetSafeNormal());
+void ACombatEnemy::ResolveDamageUI()
+{
+	// update the life bar while we're alive, it's hidden on death
+	if (CurrentHP > 0.0f)
+	{
+		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
 	}
 }
 
+void ACombatEnemy::ResolveDamageEffects(float Damage, const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	// pass control to BP to play effects, etc.
+	ReceivedDamage(Damage, DamageLocation, DamageImpulse.GetSafeNormal());
+}
+
 void ACombatEnemy::HandleDeath()
 {
 	// hide the life bar
@@ -270,9 +321,6 @@ float ACombatEnemy::TakeDamage(float Damage, struct FDamageEvent const& DamageEv
 	}
 	else
 	{
-		// update the life bar
-		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
-
 		// enable partial ragdoll physics, but keep the pelvis vertical
 		GetMesh()->SetPhysicsBlendWeight(0.5f);
 		GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
@@ -311,6 +359,12 @@ void ACombatEnemy::BeginPlay()
 
 	// fill the life bar
 	LifeBarWidget->SetLifePercentage(1.0f);
+
+	// let the significance subsystem scale our update rates with the distance to the player
+	if (UCombatSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UCombatSignificanceSubsystem>())
+	{
+		Significance->RegisterEnemy(this);
+	}
 }
 
 void ACombatEnemy::EndPlay(EEndPlayReason::Type EndPlayReason)
@@ -319,4 +373,9 @@ void ACombatEnemy::EndPlay(EEndPlayReason::Type EndPlayReason)
 
 	// clear the death timer
 	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	if (UCombatSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UCombatSignificanceSubsystem>())
+	{
+		Significance->UnregisterEnemy(this);
+	}
 }
@@ -13,6 +13,7 @@
 class UWidgetComponent;
 class UCombatLifeBar;
 class UAnimMontage;
+struct FCombatTraceRequest;
 
 /** Completed attack animation delegate for StateTree */
 DECLARE_DELEGATE(FOnEnemyAttackCompleted);
@@ -165,6 +166,15 @@ public:
 	/** Performs an attack's collision check */
 	virtual void DoAttackTrace(FName DamageSourceBone) override;
 
+	/** Starts sweeping the path of a bone every frame */
+	virtual void BeginAttackSwing(FName DamageSourceBone) override;
+
+	/** Stops sweeping the path of a bone */
+	virtual void EndAttackSwing(FName DamageSourceBone) override;
+
+	/** Applies damage to the players hit by an attack */
+	virtual void ResolveAttackHits(const TArray<FHitResult>& Hits) override;
+
 	/** Performs a combo attack's check to continue the string */
 	UFUNCTION(BlueprintCallable, Category="Attacker")
 	virtual void CheckCombo() override;
@@ -180,6 +190,18 @@ public:
 	/** Handles damage and knockback events */
 	virtual void ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse) override;
 
+	/** Applies damage to HP */
+	virtual float ResolveDamage(float Damage, AActor* DamageCauser) override;
+
+	/** Applies knockback */
+	virtual void ResolveDamageImpulse(const FVector& DamageLocation, const FVector& DamageImpulse) override;
+
+	/** Updates the life bar */
+	virtual void ResolveDamageUI() override;
+
+	/** Plays damage effects */
+	virtual void ResolveDamageEffects(float Damage, const FVector& DamageLocation, const FVector& DamageImpulse) override;
+
 	/** Handles death events */
 	virtual void HandleDeath() override;
 
@@ -193,6 +215,9 @@ protected:
 	/** Removes this character from the level after it dies */
 	void RemoveFromLevel();
 
+	/** Builds the sweep for an attack from the given bone */
+	FCombatTraceRequest MakeAttackTraceRequest(FName DamageSourceBone);
+
 public:
 
 	/** Overrides the default TakeDamage functionality */
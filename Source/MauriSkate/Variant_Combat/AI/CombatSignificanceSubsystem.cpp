@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatSignificanceSubsystem.h"
+#include "CombatEnemy.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "PlayerInfoSubsystem.h"
+
+namespace CombatSignificance
+{
+	/** Distance up to which enemies are in each bucket. Past the last one they're dormant */
+	constexpr float BucketDistances[] = { 1500.0f, 4000.0f, 10000.0f };
+
+	/** Tick interval of each bucket. Zero ticks every frame */
+	constexpr float BucketTickIntervals[] = { 0.0f, 1.0f / 15.0f, 1.0f / 5.0f, 1.0f / 2.0f };
+
+	constexpr int32 NumBuckets = static_cast<int32>(ECombatSignificance::Dormant) + 1;
+
+	static_assert(UE_ARRAY_COUNT(BucketDistances) == NumBuckets - 1, "Every bucket but the last needs a distance");
+	static_assert(UE_ARRAY_COUNT(BucketTickIntervals) == NumBuckets, "Every bucket needs a tick interval");
+}
+
+void UCombatSignificanceSubsystem::RegisterEnemy(ACombatEnemy* Enemy)
+{
+	// enemies start at full rate until the next update places them
+	FEnemySignificance& Entry = Enemies.AddDefaulted_GetRef();
+	Entry.Enemy = Enemy;
+}
+
+void UCombatSignificanceSubsystem::UnregisterEnemy(ACombatEnemy* Enemy)
+{
+	Enemies.RemoveAllSwap([Enemy](const FEnemySignificance& Entry) { return Entry.Enemy == Enemy; });
+}
+
+ECombatSignificance UCombatSignificanceSubsystem::GetSignificance(const ACombatEnemy* Enemy) const
+{
+	const FEnemySignificance* Entry = Enemies.FindByPredicate([Enemy](const FEnemySignificance& Entry) { return Entry.Enemy == Enemy; });
+	return Entry ? Entry->Significance : ECombatSignificance::High;
+}
+
+void UCombatSignificanceSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceEvaluation += DeltaTime;
+
+	if (TimeSinceEvaluation < EvaluationInterval)
+	{
+		return;
+	}
+
+	TimeSinceEvaluation = 0.0f;
+
+	UPlayerInfoSubsystem* PlayerInfo = GetWorld()->GetSubsystem<UPlayerInfoSubsystem>();
+	if (!PlayerInfo)
+	{
+		return;
+	}
+
+	// measure every enemy against the player in one batch
+	EnemyLocations.Reset();
+	for (const FEnemySignificance& Entry : Enemies)
+	{
+		const ACombatEnemy* Enemy = Entry.Enemy.Get();
+		EnemyLocations.Add(Enemy ? Enemy->GetActorLocation() : FVector::ZeroVector);
+	}
+
+	EnemyDistancesSquared.SetNumUninitialized(EnemyLocations.Num(), EAllowShrinking::No);
+
+	// without a player there's nothing to measure against, so leave everyone where they are
+	if (!PlayerInfo->GetDistancesSquared(EnemyLocations, EnemyDistancesSquared))
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < Enemies.Num(); ++Index)
+	{
+		FEnemySignificance& Entry = Enemies[Index];
+
+		ACombatEnemy* Enemy = Entry.Enemy.Get();
+		if (!Enemy)
+		{
+			continue;
+		}
+
+		const ECombatSignificance Significance = EvaluateSignificance(Enemy, EnemyDistancesSquared[Index]);
+
+		// only touch the tick functions when the bucket changes
+		if (Significance != Entry.Significance)
+		{
+			Entry.Significance = Significance;
+			ApplySignificance(Enemy, Significance);
+		}
+	}
+}
+
+ECombatSignificance UCombatSignificanceSubsystem::EvaluateSignificance(const ACombatEnemy* Enemy, float DistanceSquared)
+{
+	int32 Bucket = 0;
+	while (Bucket < CombatSignificance::NumBuckets - 1 && DistanceSquared > FMath::Square(CombatSignificance::BucketDistances[Bucket]))
+	{
+		++Bucket;
+	}
+
+	// off screen enemies can afford to update less, the player won't see the steps
+	if (!Enemy->WasRecentlyRendered(VisibilityTolerance))
+	{
+		Bucket = FMath::Min(Bucket + 1, CombatSignificance::NumBuckets - 1);
+	}
+
+	return static_cast<ECombatSignificance>(Bucket);
+}
+
+void UCombatSignificanceSubsystem::ApplySignificance(ACombatEnemy* Enemy, ECombatSignificance Significance)
+{
+	const float TickInterval = CombatSignificance::BucketTickIntervals[static_cast<int32>(Significance)];
+
+	// StateTree runs in the AI controller's brain component
+	if (const AAIController* Controller = Cast<AAIController>(Enemy->GetController()))
+	{
+		if (UBrainComponent* Brain = Controller->GetBrainComponent())
+		{
+			Brain->SetComponentTickInterval(TickInterval);
+		}
+	}
+
+	Enemy->GetCharacterMovement()->SetComponentTickInterval(TickInterval);
+	Enemy->GetMesh()->SetComponentTickInterval(TickInterval);
+}
+
+TStatId UCombatSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatSignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatSignificanceSubsystem.generated.h"
+
+class ACombatEnemy;
+
+/** How much an enemy matters to the player, from most to least */
+UENUM(BlueprintType)
+enum class ECombatSignificance : uint8
+{
+	/** Close enough to be fighting. Updates every frame */
+	High,
+
+	/** Nearby. Updates at a reduced rate */
+	Medium,
+
+	/** Far away, or nearby but off screen */
+	Low,
+
+	/** Barely relevant. Updates a few times per second */
+	Dormant
+};
+
+/**
+ *  Buckets the level's enemies by distance and visibility to the player.
+ *  Each bucket sets how often an enemy's StateTree, movement and animation tick, so arenas can keep hundreds of enemies
+ *  loaded while only the handful near the player run at full rate. Off screen enemies drop one bucket.
+ */
+UCLASS()
+class UCombatSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Time between bucket updates */
+	static constexpr float EvaluationInterval = 0.25f;
+
+	/** Time an enemy counts as visible after it was last rendered */
+	static constexpr float VisibilityTolerance = 0.5f;
+
+	/** Starts managing an enemy's update rates */
+	void RegisterEnemy(ACombatEnemy* Enemy);
+
+	/** Stops managing an enemy's update rates */
+	void UnregisterEnemy(ACombatEnemy* Enemy);
+
+	/** Returns the bucket an enemy is in */
+	ECombatSignificance GetSignificance(const ACombatEnemy* Enemy) const;
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	// ~begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// ~end UWorldSubsystem interface
+
+private:
+
+	/** A registered enemy and its current bucket */
+	struct FEnemySignificance
+	{
+		TWeakObjectPtr<ACombatEnemy> Enemy;
+		ECombatSignificance Significance = ECombatSignificance::High;
+	};
+
+	/** Works out an enemy's bucket from its squared distance to the player */
+	static ECombatSignificance EvaluateSignificance(const ACombatEnemy* Enemy, float DistanceSquared);
+
+	/** Sets the tick rates of an enemy's StateTree, movement and animation */
+	static void ApplySignificance(ACombatEnemy* Enemy, ECombatSignificance Significance);
+
+	/** Registered enemies */
+	TArray<FEnemySignificance> Enemies;
+
+	/** Enemy locations and their squared distances to the player, in Enemies order. Kept to reuse their memory */
+	TArray<FVector> EnemyLocations;
+	TArray<float> EnemyDistancesSquared;
+
+	/** Time since the last bucket update */
+	float TimeSinceEvaluation = 0.0f;
+};
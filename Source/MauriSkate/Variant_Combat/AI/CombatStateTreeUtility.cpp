@@ -8,8 +8,8 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "AIController.h"
 #include "CombatEnemy.h"
-#include "Kismet/GameplayStatics.h"
 #include "StateTreeAsyncExecutionContext.h"
+#include "PlayerInfoSubsystem.h"
 
 bool FStateTreeCharacterGroundedCondition::TestCondition(FStateTreeExecutionContext& Context) const
 {
@@ -266,14 +266,17 @@ EStateTreeRunStatus FStateTreeGetPlayerInfoTask::Tick(FStateTreeExecutionContext
 	// get the instance data
 	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-	// get the character possessed by the first local player
-	InstanceData.TargetPlayerCharacter = Cast<ACharacter>(UGameplayStatics::GetPlayerPawn(InstanceData.Character, 0));
+	// get the character possessed by the first local player from the shared player info
+	UPlayerInfoSubsystem* PlayerInfo = Context.GetWorld()->GetSubsystem<UPlayerInfoSubsystem>();
+	const FPlayerInfo* Player = PlayerInfo ? PlayerInfo->GetPlayer(0) : nullptr;
+
+	InstanceData.TargetPlayerCharacter = Player ? Cast<ACharacter>(Player->Pawn.Get()) : nullptr;
 
 	// do we have a valid target?
 	if (InstanceData.TargetPlayerCharacter)
 	{
 		// update the last known location
-		InstanceData.TargetPlayerLocation = InstanceData.TargetPlayerCharacter->GetActorLocation();
+		InstanceData.TargetPlayerLocation = Player->Location;
 	}
 
 	// update the distance
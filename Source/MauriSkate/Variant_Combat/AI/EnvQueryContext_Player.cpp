@@ -2,15 +2,18 @@
 
 
 #include "EnvQueryContext_Player.h"
-#include "Kismet/GameplayStatics.h"
+#include "PlayerInfoSubsystem.h"
 #include "EnvironmentQuery/EnvQueryTypes.h"
 #include "EnvironmentQuery/Items/EnvQueryItemType_Actor.h"
 #include "GameFramework/Pawn.h"
 
 void UEnvQueryContext_Player::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const
 {
-	// get the player pawn for the first local player
-	AActor* PlayerPawn = UGameplayStatics::GetPlayerPawn(QueryInstance.Owner.Get(), 0);
+	// get the player pawn for the first local player from the shared player info
+	UPlayerInfoSubsystem* PlayerInfo = QueryInstance.World->GetSubsystem<UPlayerInfoSubsystem>();
+	check(PlayerInfo);
+
+	AActor* PlayerPawn = PlayerInfo->GetPlayerPawn(0);
 	check(PlayerPawn);
 
 	// add the actor data to the context
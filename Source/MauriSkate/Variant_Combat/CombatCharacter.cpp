@@ -15,6 +15,8 @@
 #include "TimerManager.h"
 #include "Engine/LocalPlayer.h"
 #include "CombatPlayerController.h"
+#include "CombatTraceSubsystem.h"
+#include "CombatDamageSubsystem.h"
 
 ACombatCharacter::ACombatCharacter()
 {
@@ -240,47 +242,70 @@ void ACombatCharacter::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupt
 	}
 }
 
-void ACombatCharacter::DoAttackTrace(FName DamageSourceBone)
+FCombatTraceRequest ACombatCharacter::MakeAttackTraceRequest(FName DamageSourceBone)
 {
-	// sweep for objects in front of the character to be hit by the attack
-	TArray<FHitResult> OutHits;
+	FCombatTraceRequest Request;
+	Request.Attacker = this;
 
 	// start at the provided socket location, sweep forward
-	const FVector TraceStart = GetMesh()->GetSocketLocation(DamageSourceBone);
-	const FVector TraceEnd = TraceStart + (GetActorForwardVector() * MeleeTraceDistance);
+	Request.Start = GetMesh()->GetSocketLocation(DamageSourceBone);
+	Request.End = Request.Start + (GetActorForwardVector() * MeleeTraceDistance);
+
+	// use a sphere shape for the sweep
+	Request.Radius = MeleeTraceRadius;
 
 	// check for pawn and world dynamic collision object types
-	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
-	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	Request.ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	Request.ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
 
-	// use a sphere shape for the sweep
-	FCollisionShape CollisionShape;
-	CollisionShape.SetSphere(MeleeTraceRadius);
+	return Request;
+}
 
-	// ignore self
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
+void ACombatCharacter::DoAttackTrace(FName DamageSourceBone)
+{
+	// queue a sweep for objects in front of the character to be hit by the attack
+	// the hits come back through ResolveAttackHits on the next frame
+	if (UCombatTraceSubsystem* TraceSubsystem = GetWorld()->GetSubsystem<UCombatTraceSubsystem>())
+	{
+		TraceSubsystem->SubmitSweep(MakeAttackTraceRequest(DamageSourceBone));
+	}
+}
 
-	if (GetWorld()->SweepMultiByObjectType(OutHits, TraceStart, TraceEnd, FQuat::Identity, ObjectParams, CollisionShape, QueryParams))
+void ACombatCharacter::BeginAttackSwing(FName DamageSourceBone)
+{
+	// sweep the bone's path each frame until the swing ends
+	if (UCombatTraceSubsystem* TraceSubsystem = GetWorld()->GetSubsystem<UCombatTraceSubsystem>())
 	{
-		// iterate over each object hit
-		for (const FHitResult& CurrentHit : OutHits)
-		{
-			// check if we've hit a damageable actor
-			ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
+		TraceSubsystem->BeginSwing(MakeAttackTraceRequest(DamageSourceBone), GetMesh(), DamageSourceBone);
+	}
+}
 
-			if (Damageable)
-			{
-				// knock upwards and away from the impact normal
-				const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
+void ACombatCharacter::EndAttackSwing(FName DamageSourceBone)
+{
+	if (UCombatTraceSubsystem* TraceSubsystem = GetWorld()->GetSubsystem<UCombatTraceSubsystem>())
+	{
+		TraceSubsystem->EndSwing(this, DamageSourceBone);
+	}
+}
 
-				// pass the damage event to the actor
-				Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+void ACombatCharacter::ResolveAttackHits(const TArray<FHitResult>& Hits)
+{
+	// iterate over each object hit
+	for (const FHitResult& CurrentHit : Hits)
+	{
+		// check if we've hit a damageable actor
+		ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
 
-				// call the BP handler to play effects, etc.
-				DealtDamage(MeleeDamage, CurrentHit.ImpactPoint);
-			}
+		if (Damageable)
+		{
+			// knock upwards and away from the impact normal
+			const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
+
+			// pass the damage event to the actor
+			Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+
+			// call the BP handler to play effects, etc.
+			DealtDamage(MeleeDamage, CurrentHit.ImpactPoint);
 		}
 	}
 }
@@ -325,28 +350,47 @@ void ACombatCharacter::CheckChargedAttack()
 }
 
 void ACombatCharacter::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	// queue the damage, it's resolved next frame together with everything else that hit us
+	if (UCombatDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UCombatDamageSubsystem>())
+	{
+		DamageSubsystem->QueueDamage(this, Damage, DamageCauser, DamageLocation, DamageImpulse);
+	}
+}
+
+float ACombatCharacter::ResolveDamage(float Damage, AActor* DamageCauser)
 {
 	// pass the damage event to the actor
 	FDamageEvent DamageEvent;
-	const float ActualDamage = TakeDamage(Damage, DamageEvent, nullptr, DamageCauser);
+	return TakeDamage(Damage, DamageEvent, nullptr, DamageCauser);
+}
 
-	// only process knockback and effects if we received nonzero damage
-	if (ActualDamage > 0.0f)
-	{
-		// apply the knockback impulse
-		GetCharacterMovement()->AddImpulse(DamageImpulse, true);
+void ACombatCharacter::ResolveDamageImpulse(const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	// apply the knockback impulse
+	GetCharacterMovement()->AddImpulse(DamageImpulse, true);
 
-		// is the character ragdolling?
-		if (GetMesh()->IsSimulatingPhysics())
-		{
-			// apply an impulse to the ragdoll
-			GetMesh()->AddImpulseAtLocation(DamageImpulse * GetMesh()->GetMass(), DamageLocation);
-		}
+	// is the character ragdolling?
+	if (GetMesh()->IsSimulatingPhysics())
+	{
+		// apply an impulse to the ragdoll
+		GetMesh()->AddImpulseAtLocation(DamageImpulse * GetMesh()->GetMass(), DamageLocation);
+	}
+}
 
-		// pass control to BP to play effects, etc.
-		ReceivedDamage(ActualDamage, DamageLocation, DamageImpulse.GetSafeNormal());
+void ACombatCharacter::ResolveDamageUI()
+{
+	// update the life bar while we're alive, it's hidden on death
+	if (CurrentHP > 0.0f)
+	{
+		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
 	}
+}
 
+void ACombatCharacter::ResolveDamageEffects(float Damage, const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	// pass control to BP to play effects, etc.
+	ReceivedDamage(Damage, DamageLocation, DamageImpulse.GetSafeNormal());
 }
 
 void ACombatCharacter::HandleDeath()
@@ -397,9 +441,6 @@ float ACombatCharacter::TakeDamage(float Damage, struct FDamageEvent const& Dama
 	}
 	else
 	{
-		// update the life bar
-		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
-
 		// enable partial ragdoll physics, but keep the pelvis vertical
 		GetMesh()->SetPhysicsBlendWeight(0.5f);
 		GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
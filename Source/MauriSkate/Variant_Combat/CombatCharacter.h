@@ -15,6 +15,7 @@ class UInputAction;
 struct FInputActionValue;
 class UCombatLifeBar;
 class UWidgetComponent;
+struct FCombatTraceRequest;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogCombatCharacter, Log, All);
 
@@ -235,6 +236,9 @@ protected:
 	/** Called from a delegate when the attack montage ends */
 	void AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted);
 
+	/** Builds the sweep for an attack from the given bone */
+	FCombatTraceRequest MakeAttackTraceRequest(FName DamageSourceBone);
+
 	
 public:
 
@@ -243,6 +247,15 @@ public:
 	/** Performs the collision check for an attack */
 	virtual void DoAttackTrace(FName DamageSourceBone) override;
 
+	/** Starts sweeping the path of a bone every frame */
+	virtual void BeginAttackSwing(FName DamageSourceBone) override;
+
+	/** Stops sweeping the path of a bone */
+	virtual void EndAttackSwing(FName DamageSourceBone) override;
+
+	/** Applies damage to the actors hit by an attack */
+	virtual void ResolveAttackHits(const TArray<FHitResult>& Hits) override;
+
 	/** Performs the combo string check */
 	virtual void CheckCombo() override;
 
@@ -256,6 +269,18 @@ public:
 	/** Handles damage and knockback events */
 	virtual void ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse) override;
 
+	/** Applies damage to HP */
+	virtual float ResolveDamage(float Damage, AActor* DamageCauser) override;
+
+	/** Applies knockback */
+	virtual void ResolveDamageImpulse(const FVector& DamageLocation, const FVector& DamageImpulse) override;
+
+	/** Updates the life bar */
+	virtual void ResolveDamageUI() override;
+
+	/** Plays damage effects */
+	virtual void ResolveDamageEffects(float Damage, const FVector& DamageLocation, const FVector& DamageImpulse) override;
+
 	/** Handles death events */
 	virtual void HandleDeath() override;
 
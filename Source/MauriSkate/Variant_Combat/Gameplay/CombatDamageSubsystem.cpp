@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatDamageSubsystem.h"
+#include "CombatDamageable.h"
+
+void UCombatDamageSubsystem::QueueDamage(AActor* Target, float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	FCombatDamageRecord& Record = Records.AddDefaulted_GetRef();
+	Record.Target = Target;
+	Record.Causer = DamageCauser;
+	Record.Damage = Damage;
+	Record.Location = DamageLocation;
+	Record.Impulse = DamageImpulse;
+	Record.Frame = GFrameCounter;
+}
+
+void UCombatDamageSubsystem::Tick(float DeltaTime)
+{
+	// damage queued this frame waits for the next one, so it doesn't matter if its source ticks before or after us
+	int32 NumReady = 0;
+	while (NumReady < Records.Num() && Records[NumReady].Frame < GFrameCounter)
+	{
+		++NumReady;
+	}
+
+	if (NumReady == 0)
+	{
+		return;
+	}
+
+	// merge into one event per target, in the order they were first damaged
+	MergedDamage.Reset();
+	MergedIndices.Reset();
+
+	for (int32 Index = 0; Index < NumReady; ++Index)
+	{
+		const FCombatDamageRecord& Record = Records[Index];
+
+		AActor* Target = Record.Target.Get();
+		if (!Target)
+		{
+			continue;
+		}
+
+		if (const int32* MergedIndex = MergedIndices.Find(TObjectKey<AActor>(Target)))
+		{
+			FMergedDamage& Merged = MergedDamage[*MergedIndex];
+			Merged.Damage += Record.Damage;
+			Merged.Impulse += Record.Impulse;
+		}
+		else
+		{
+			MergedIndices.Add(TObjectKey<AActor>(Target), MergedDamage.Num());
+
+			FMergedDamage& Merged = MergedDamage.AddDefaulted_GetRef();
+			Merged.Target = Target;
+			Merged.Causer = Record.Causer;
+			Merged.Damage = Record.Damage;
+			Merged.Location = Record.Location;
+			Merged.Impulse = Record.Impulse;
+		}
+	}
+
+	Records.RemoveAt(0, NumReady, EAllowShrinking::No);
+
+	// HP, which may also kill the target
+	for (FMergedDamage& Merged : MergedDamage)
+	{
+		if (ICombatDamageable* Damageable = Cast<ICombatDamageable>(Merged.Target.Get()))
+		{
+			Merged.ActualDamage = Damageable->ResolveDamage(Merged.Damage, Merged.Causer.Get());
+		}
+	}
+
+	// only targets that took damage react to it
+	for (const FMergedDamage& Merged : MergedDamage)
+	{
+		ICombatDamageable* Damageable = Cast<ICombatDamageable>(Merged.Target.Get());
+		if (Damageable && Merged.ActualDamage > 0.0f)
+		{
+			Damageable->ResolveDamageImpulse(Merged.Location, Merged.Impulse);
+		}
+	}
+
+	for (const FMergedDamage& Merged : MergedDamage)
+	{
+		ICombatDamageable* Damageable = Cast<ICombatDamageable>(Merged.Target.Get());
+		if (Damageable && Merged.ActualDamage > 0.0f)
+		{
+			Damageable->ResolveDamageUI();
+		}
+	}
+
+	for (const FMergedDamage& Merged : MergedDamage)
+	{
+		ICombatDamageable* Damageable = Cast<ICombatDamageable>(Merged.Target.Get());
+		if (Damageable && Merged.ActualDamage > 0.0f)
+		{
+			Damageable->ResolveDamageEffects(Merged.ActualDamage, Merged.Location, Merged.Impulse);
+		}
+	}
+}
+
+TStatId UCombatDamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatDamageSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatDamageSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "CombatDamageSubsystem.generated.h"
+
+/** A damage event waiting to be resolved */
+struct FCombatDamageRecord
+{
+	/** Damaged actor. Must implement ICombatDamageable */
+	TWeakObjectPtr<AActor> Target;
+
+	/** Actor that caused the damage */
+	TWeakObjectPtr<AActor> Causer;
+
+	float Damage = 0.0f;
+	FVector Location = FVector::ZeroVector;
+	FVector Impulse = FVector::ZeroVector;
+
+	/** Frame the damage was queued on */
+	uint64 Frame = 0;
+};
+
+/**
+ *  Collects the damage dealt in the level and resolves it once per frame.
+ *  Damage queued on a frame is resolved on the next one, merged into a single event per target, in the order the targets
+ *  were first damaged. All targets go through each phase before the next one starts: HP, then physics impulses, then UI,
+ *  then effects.
+ */
+UCLASS()
+class UCombatDamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Queues damage for the target. Resolved on the next frame */
+	void QueueDamage(AActor* Target, float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse);
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	// ~begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// ~end UWorldSubsystem interface
+
+private:
+
+	/** All the damage a target took on one frame */
+	struct FMergedDamage
+	{
+		TWeakObjectPtr<AActor> Target;
+		TWeakObjectPtr<AActor> Causer;
+		float Damage = 0.0f;
+		FVector Location = FVector::ZeroVector;
+		FVector Impulse = FVector::ZeroVector;
+
+		/** Damage the target actually took in the HP phase */
+		float ActualDamage = 0.0f;
+	};
+
+	/** Queued damage, oldest first */
+	TArray<FCombatDamageRecord> Records;
+
+	/** Damage being resolved this frame, one per target. Kept to reuse its memory */
+	TArray<FMergedDamage> MergedDamage;
+
+	/** Index of each target in MergedDamage */
+	TMap<TObjectKey<AActor>, int32> MergedIndices;
+};
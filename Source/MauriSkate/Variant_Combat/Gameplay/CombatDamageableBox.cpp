@@ -5,6 +5,7 @@
 #include "Components/StaticMeshComponent.h"
 #include "TimerManager.h"
 #include "Engine/World.h"
+#include "CombatDamageSubsystem.h"
 
 ACombatDamageableBox::ACombatDamageableBox()
 {
@@ -39,24 +40,48 @@ void ACombatDamageableBox::EndPlay(EEndPlayReason::Type EndPlayReason)
 
 void ACombatDamageableBox::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
 {
-	// only process damage if we still have HP
-	if (CurrentHP > 0.0f)
+	// queue the damage, it's resolved next frame together with everything else that hit us
+	if (UCombatDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UCombatDamageSubsystem>())
 	{
-		// apply the damage
-		CurrentHP -= Damage;
+		DamageSubsystem->QueueDamage(this, Damage, DamageCauser, DamageLocation, DamageImpulse);
+	}
+}
 
-		// are we dead?
-		if (CurrentHP <= 0.0f)
-		{
-			HandleDeath();
-		}
+float ACombatDamageableBox::ResolveDamage(float Damage, AActor* DamageCauser)
+{
+	// only process damage if we still have HP
+	if (CurrentHP <= 0.0f)
+	{
+		return 0.0f;
+	}
 
-		// apply a physics impulse to the box, ignoring its mass
-		Mesh->AddImpulseAtLocation(DamageImpulse * Mesh->GetMass(), DamageLocation);
+	// apply the damage
+	CurrentHP -= Damage;
 
-		// call the BP handler to play effects, etc.
-		OnBoxDamaged(DamageLocation, DamageImpulse);
+	// are we dead?
+	if (CurrentHP <= 0.0f)
+	{
+		HandleDeath();
 	}
+
+	return Damage;
+}
+
+void ACombatDamageableBox::ResolveDamageImpulse(const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	// apply a physics impulse to the box, ignoring its mass
+	Mesh->AddImpulseAtLocation(DamageImpulse * Mesh->GetMass(), DamageLocation);
+}
+
+void ACombatDamageableBox::ResolveDamageUI()
+{
+	// unused
+}
+
+void ACombatDamageableBox::ResolveDamageEffects(float Damage, const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	// call the BP handler to play effects, etc.
+	OnBoxDamaged(DamageLocation, DamageImpulse);
 }
 
 void ACombatDamageableBox::HandleDeath()
@@ -58,6 +58,18 @@ public:
 	/** Handles damage and knockback events */
 	virtual void ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse) override;
 
+	/** Applies damage to HP */
+	virtual float ResolveDamage(float Damage, AActor* DamageCauser) override;
+
+	/** Applies knockback */
+	virtual void ResolveDamageImpulse(const FVector& DamageLocation, const FVector& DamageImpulse) override;
+
+	/** Unused, boxes have no health UI */
+	virtual void ResolveDamageUI() override;
+
+	/** Plays damage effects */
+	virtual void ResolveDamageEffects(float Damage, const FVector& DamageLocation, const FVector& DamageImpulse) override;
+
 	/** Handles death events */
 	virtual void HandleDeath() override;
 
@@ -5,6 +5,8 @@
 #include "Components/SceneComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "PhysicsEngine/PhysicsConstraintComponent.h"
+#include "Engine/World.h"
+#include "CombatDamageSubsystem.h"
 
 ACombatDummy::ACombatDummy()
 {
@@ -32,10 +34,33 @@ ACombatDummy::ACombatDummy()
 }
 
 void ACombatDummy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	// queue the damage, it's resolved next frame together with everything else that hit us
+	if (UCombatDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UCombatDamageSubsystem>())
+	{
+		DamageSubsystem->QueueDamage(this, Damage, DamageCauser, DamageLocation, DamageImpulse);
+	}
+}
+
+float ACombatDummy::ResolveDamage(float Damage, AActor* DamageCauser)
+{
+	// the dummy is invincible, but still reacts to every hit
+	return Damage;
+}
+
+void ACombatDummy::ResolveDamageImpulse(const FVector& DamageLocation, const FVector& DamageImpulse)
 {
 	// apply impulse to the dummy
 	Dummy->AddImpulseAtLocation(DamageImpulse, DamageLocation);
+}
+
+void ACombatDummy::ResolveDamageUI()
+{
+	// unused
+}
 
+void ACombatDummy::ResolveDamageEffects(float Damage, const FVector& DamageLocation, const FVector& DamageImpulse)
+{
 	// call the BP handler
 	BP_OnDummyDamaged(DamageLocation, DamageImpulse.GetSafeNormal());
 }
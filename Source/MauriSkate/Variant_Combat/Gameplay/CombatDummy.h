@@ -44,6 +44,18 @@ public:
 		/** Handles damage and knockback events */
 	virtual void ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse) override;
 
+	/** Takes the damage without losing HP */
+	virtual float ResolveDamage(float Damage, AActor* DamageCauser) override;
+
+	/** Applies knockback */
+	virtual void ResolveDamageImpulse(const FVector& DamageLocation, const FVector& DamageImpulse) override;
+
+	/** Unused, dummies have no health UI */
+	virtual void ResolveDamageUI() override;
+
+	/** Plays damage effects */
+	virtual void ResolveDamageEffects(float Damage, const FVector& DamageLocation, const FVector& DamageImpulse) override;
+
 	/** Handles death events */
 	virtual void HandleDeath() override;
 
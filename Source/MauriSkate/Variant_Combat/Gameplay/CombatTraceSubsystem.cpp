@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatTraceSubsystem.h"
+#include "CombatAttacker.h"
+#include "Engine/World.h"
+#include "Components/SkeletalMeshComponent.h"
+
+UCombatTraceSubsystem::UCombatTraceSubsystem()
+{
+	SweepDelegate.BindUObject(this, &UCombatTraceSubsystem::OnSweepDone);
+}
+
+void UCombatTraceSubsystem::SubmitSweep(const FCombatTraceRequest& Request)
+{
+	PendingRequests.Add(Request);
+}
+
+void UCombatTraceSubsystem::BeginSwing(const FCombatTraceRequest& Request, USkeletalMeshComponent* Mesh, FName Bone)
+{
+	if (!Mesh)
+	{
+		return;
+	}
+
+	// restarting the same swing starts over with a clean hit list
+	EndSwing(Request.Attacker.Get(), Bone);
+
+	FAttackSwing& Swing = Swings.Add(NextSwingId++);
+	Swing.Request = Request;
+	Swing.Mesh = Mesh;
+	Swing.Bone = Bone;
+	Swing.PreviousLocation = Mesh->GetSocketLocation(Bone);
+}
+
+void UCombatTraceSubsystem::EndSwing(AActor* Attacker, FName Bone)
+{
+	for (TPair<int32, FAttackSwing>& Pair : Swings)
+	{
+		FAttackSwing& Swing = Pair.Value;
+
+		if (Swing.Request.Attacker.Get() == Attacker && Swing.Bone == Bone)
+		{
+			Swing.bEnding = true;
+		}
+	}
+}
+
+void UCombatTraceSubsystem::Tick(float DeltaTime)
+{
+	// hold the next batch until the last one is complete, so every batch resolves as a whole
+	for (const FInFlightSweep& Sweep : InFlightSweeps)
+	{
+		if (!Sweep.bDone)
+		{
+			return;
+		}
+	}
+
+	// resolve last frame's sweeps in one pass, in the order they were submitted
+	for (FInFlightSweep& Sweep : InFlightSweeps)
+	{
+		ICombatAttacker* Attacker = Cast<ICombatAttacker>(Sweep.Attacker.Get());
+		if (!Attacker)
+		{
+			continue;
+		}
+
+		// swings remember their hits across frames, single sweeps only within themselves
+		FAttackSwing* Swing = Swings.Find(Sweep.SwingId);
+		FHitActorSet SweepHitActors;
+		FHitActorSet& HitActors = Swing ? Swing->HitActors : SweepHitActors;
+
+		// keep the first hit on each actor, the others are just more of its components
+		Sweep.Hits.RemoveAll([&HitActors](const FHitResult& Hit)
+		{
+			bool bAlreadyHit = true;
+
+			if (AActor* HitActor = Hit.GetActor())
+			{
+				HitActors.Add(TObjectKey<AActor>(HitActor), &bAlreadyHit);
+			}
+
+			return bAlreadyHit;
+		});
+
+		if (Sweep.Hits.Num() > 0)
+		{
+			Attacker->ResolveAttackHits(Sweep.Hits);
+		}
+	}
+
+	InFlightSweeps.Reset();
+
+	// swings whose last sweep just resolved are done
+	for (auto It = Swings.CreateIterator(); It; ++It)
+	{
+		if (It.Value().bFinished)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// issue this frame's sweeps together
+	for (const FCombatTraceRequest& Request : PendingRequests)
+	{
+		IssueSweep(Request, INDEX_NONE);
+	}
+
+	PendingRequests.Reset();
+
+	for (auto It = Swings.CreateIterator(); It; ++It)
+	{
+		FAttackSwing& Swing = It.Value();
+
+		// the attacker or its mesh went away mid swing
+		if (!Swing.Request.Attacker.IsValid() || !Swing.Mesh.IsValid())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		SweepSwing(It.Key(), Swing);
+	}
+}
+
+void UCombatTraceSubsystem::SweepSwing(int32 SwingId, FAttackSwing& Swing)
+{
+	// sweep the whole path of the bone since the last frame, so fast swings can't pass through a target
+	const FVector Location = Swing.Mesh->GetSocketLocation(Swing.Bone);
+
+	FCombatTraceRequest Request = Swing.Request;
+	Request.Start = Swing.PreviousLocation;
+	Request.End = Location;
+
+	IssueSweep(Request, SwingId);
+
+	Swing.PreviousLocation = Location;
+	Swing.bFinished = Swing.bEnding;
+}
+
+void UCombatTraceSubsystem::IssueSweep(const FCombatTraceRequest& Request, int32 SwingId)
+{
+	AActor* Attacker = Request.Attacker.Get();
+	if (!Attacker)
+	{
+		return;
+	}
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(CombatTrace), false, Attacker);
+
+	const int32 Index = InFlightSweeps.AddDefaulted();
+	InFlightSweeps[Index].Attacker = Attacker;
+	InFlightSweeps[Index].SwingId = SwingId;
+
+	GetWorld()->AsyncSweepByObjectType(EAsyncTraceType::Multi, Request.Start, Request.End, FQuat::Identity, Request.ObjectParams,
+		FCollisionShape::MakeSphere(Request.Radius), QueryParams, &SweepDelegate, Index);
+}
+
+void UCombatTraceSubsystem::OnSweepDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	if (InFlightSweeps.IsValidIndex(TraceDatum.UserData))
+	{
+		FInFlightSweep& Sweep = InFlightSweeps[TraceDatum.UserData];
+		Sweep.Hits = MoveTemp(TraceDatum.OutHits);
+		Sweep.bDone = true;
+	}
+}
+
+TStatId UCombatTraceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatTraceSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatTraceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
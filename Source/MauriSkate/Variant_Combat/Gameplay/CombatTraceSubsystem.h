@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "UObject/ObjectKey.h"
+#include "CombatTraceSubsystem.generated.h"
+
+/** A melee sweep requested by an attacker */
+struct FCombatTraceRequest
+{
+	/** Attacker the hits are handed back to. Must implement ICombatAttacker */
+	TWeakObjectPtr<AActor> Attacker;
+
+	/** Sweep start and end */
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+
+	/** Radius of the swept sphere */
+	float Radius = 0.0f;
+
+	/** Object types the sweep looks for */
+	FCollisionObjectQueryParams ObjectParams;
+};
+
+class USkeletalMeshComponent;
+
+/**
+ *  Queues melee sweeps for the whole level.
+ *  Attack notifies submit sweeps at any point in the frame. They are all issued together as async sweeps once per frame,
+ *  and their hits are handed back to the attackers in a single pass on the next frame, in the order they were submitted.
+ */
+UCLASS()
+class UCombatTraceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Constructor */
+	UCombatTraceSubsystem();
+
+	/** Queues a sweep. Its hits reach the attacker's ResolveAttackHits on the next frame */
+	void SubmitSweep(const FCombatTraceRequest& Request);
+
+	/** Starts sweeping the path of a bone every frame. The request's start and end are ignored */
+	void BeginSwing(const FCombatTraceRequest& Request, USkeletalMeshComponent* Mesh, FName Bone);
+
+	/** Stops a swing after one last sweep up to the bone's current location */
+	void EndSwing(AActor* Attacker, FName Bone);
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	// ~begin UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	// ~end UWorldSubsystem interface
+
+	/** Stores the result of an issued sweep */
+	void OnSweepDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+private:
+
+	/** An issued sweep waiting for its result */
+	struct FInFlightSweep
+	{
+		TWeakObjectPtr<AActor> Attacker;
+		TArray<FHitResult> Hits;
+		int32 SwingId = INDEX_NONE;
+		bool bDone = false;
+	};
+
+	/** Actors already hit by a sweep or swing. Few enough to stay inline */
+	using FHitActorSet = TSet<TObjectKey<AActor>, DefaultKeyFuncs<TObjectKey<AActor>>, TInlineSetAllocator<8>>;
+
+	/** An attack that sweeps a bone's path over several frames */
+	struct FAttackSwing
+	{
+		FCombatTraceRequest Request;
+		TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+		FName Bone;
+
+		/** Bone location at the last sweep */
+		FVector PreviousLocation = FVector::ZeroVector;
+
+		/** Actors this swing already hit */
+		FHitActorSet HitActors;
+
+		/** Set by EndSwing. The next sweep is the last */
+		bool bEnding = false;
+
+		/** Set once the last sweep is issued. Removed when it resolves */
+		bool bFinished = false;
+	};
+
+	/** Queues the sweep from a swing's last bone location to its current one */
+	void SweepSwing(int32 SwingId, FAttackSwing& Swing);
+
+	/** Issues a sweep as part of the current batch */
+	void IssueSweep(const FCombatTraceRequest& Request, int32 SwingId);
+
+	/** Sweeps submitted this frame */
+	TArray<FCombatTraceRequest> PendingRequests;
+
+	/** Sweeps issued last frame, indexed by their trace user data */
+	TArray<FInFlightSweep> InFlightSweeps;
+
+	/** Active swings, by id */
+	TMap<int32, FAttackSwing> Swings;
+
+	/** Id for the next swing */
+	int32 NextSwingId = 0;
+
+	/** Callback for the issued sweeps */
+	FTraceDelegate SweepDelegate;
+};
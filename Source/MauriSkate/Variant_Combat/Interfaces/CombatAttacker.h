@@ -6,6 +6,8 @@
 #include "UObject/Interface.h"
 #include "CombatAttacker.generated.h"
 
+struct FHitResult;
+
 /**
  *  CombatAttacker Interface
  *  Provides common functionality to trigger attack animation events.
@@ -26,6 +28,17 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Attacker")
 	virtual void DoAttackTrace(FName DamageSourceBone) = 0;
 
+	/** Starts sweeping the path of a bone every frame until EndAttackSwing. Usually called from a montage's AnimNotifyState */
+	UFUNCTION(BlueprintCallable, Category="Attacker")
+	virtual void BeginAttackSwing(FName DamageSourceBone) = 0;
+
+	/** Stops the swing started by BeginAttackSwing. Usually called from a montage's AnimNotifyState */
+	UFUNCTION(BlueprintCallable, Category="Attacker")
+	virtual void EndAttackSwing(FName DamageSourceBone) = 0;
+
+	/** Applies the hits of an attack's collision check. Called by UCombatTraceSubsystem the frame after the check is queued, with each actor hit at most once per attack */
+	virtual void ResolveAttackHits(const TArray<FHitResult>& Hits) = 0;
+
 	/** Performs a combo attack's check to continue the string. Usually called from a montage's AnimNotify */
 	UFUNCTION(BlueprintCallable, Category="Attacker")
 	virtual void CheckCombo() = 0;
@@ -22,10 +22,22 @@ class ICombatDamageable
 
 public:
 
-	/** Handles damage and knockback events */
+	/** Handles damage and knockback events. Implementations queue the damage with UCombatDamageSubsystem */
 	UFUNCTION(BlueprintCallable, Category="Damageable")
 	virtual void ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse) = 0;
 
+	/** First damage resolve phase. Applies a frame's total damage to HP and returns the damage actually taken */
+	virtual float ResolveDamage(float Damage, AActor* DamageCauser) = 0;
+
+	/** Second damage resolve phase. Applies a frame's total knockback */
+	virtual void ResolveDamageImpulse(const FVector& DamageLocation, const FVector& DamageImpulse) = 0;
+
+	/** Third damage resolve phase. Updates any health UI */
+	virtual void ResolveDamageUI() = 0;
+
+	/** Last damage resolve phase. Plays damage effects */
+	virtual void ResolveDamageEffects(float Damage, const FVector& DamageLocation, const FVector& DamageImpulse) = 0;
+
 	/** Handles death events */
 	UFUNCTION(BlueprintCallable, Category="Damageable")
 	virtual void HandleDeath() = 0;
@@ -5,20 +5,23 @@
 #include "StateTreeExecutionContext.h"
 #include "StateTreeExecutionTypes.h"
 #include "AIController.h"
-#include "Kismet/GameplayStatics.h"
+#include "PlayerInfoSubsystem.h"
 
 EStateTreeRunStatus FStateTreeGetPlayerTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
 {
 	// get the instance data
 	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-	// set the player pawn as the target
-	InstanceData.TargetPlayer = UGameplayStatics::GetPlayerPawn(InstanceData.Controller.Get(), 0);
+	// set the player pawn as the target, from the shared player info
+	UPlayerInfoSubsystem* PlayerInfo = Context.GetWorld()->GetSubsystem<UPlayerInfoSubsystem>();
+	const FPlayerInfo* Player = PlayerInfo ? PlayerInfo->GetPlayer(0) : nullptr;
+
+	InstanceData.TargetPlayer = Player ? Player->Pawn.Get() : nullptr;
 
 	// are the NPC and target valid?
 	if (IsValid(InstanceData.TargetPlayer) && IsValid(InstanceData.NPC))
 	{
-		InstanceData.bValidTarget = FVector::Distance(InstanceData.NPC->GetActorLocation(), InstanceData.TargetPlayer->GetActorLocation()) < InstanceData.RangeMax;
+		InstanceData.bValidTarget = FVector::DistSquared(InstanceData.NPC->GetActorLocation(), Player->Location) < FMath::Square(InstanceData.RangeMax);
 	}
 
 	return EStateTreeRunStatus::Running;